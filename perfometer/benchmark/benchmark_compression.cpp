@@ -0,0 +1,201 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <perfometer/compression.h>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <utils/report_reader.h>
+#include <utils/time.h>
+#include <utils/timer.h>
+
+// Measures page compression on workloads modeled after samples: report size and logging time
+// with compression on and off, then raw codec throughput on pages of uncompressed report
+
+constexpr size_t num_threads = 10;
+constexpr size_t tasks_per_thread = 20000;
+constexpr int codec_iterations = 20;
+
+struct record_counter : perfometer::utils::report_reader
+{
+    void handle_work(perfometer::string_id, perfometer::utils::perf_thread_id, double, double) override { m_records++; }
+    void handle_wait(perfometer::string_id, perfometer::utils::perf_thread_id, double, double) override { m_records++; }
+    void handle_event(perfometer::string_id, perfometer::utils::perf_thread_id, double) override { m_records++; }
+
+    size_t m_records = 0;
+};
+
+void wait()
+{
+    PERFOMETER_LOG_WAIT_FUNCTION();
+}
+
+void sub_task()
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+}
+
+// same scope nesting as threads sample without sleeping
+void task(size_t i)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    sub_task();
+
+    wait();
+
+    sub_task();
+
+    if (i % 16 == 0)
+    {
+        PERFOMETER_LOG_EVENT("Checkpoint");
+    }
+}
+
+size_t file_size(const char* file_name)
+{
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+}
+
+size_t benchmark_workload(const char* file_name, bool compression)
+{
+    std::cout << "benchmark_workload " << (compression ? "compressed" : "uncompressed") << std::endl;
+
+    perfometer::configuration config;
+    config.file_name = file_name;
+    config.compression = compression;
+
+    perfometer::initialize(config);
+
+    {
+        perfometer::utils::logging_timer timer;
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([]()
+            {
+                PERFOMETER_LOG_THREAD_NAME("WORKER");
+
+                for (size_t i = 0; i < tasks_per_thread; ++i)
+                {
+                    task(i);
+                }
+
+                perfometer::flush_thread_cache();
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        perfometer::shutdown();
+    }
+
+    record_counter counter;
+    counter.process(file_name);
+
+    size_t size = file_size(file_name);
+    std::cout << "report " << size << " bytes, " << counter.m_records << " records" << std::endl;
+
+    return size;
+}
+
+void benchmark_codec(const char* file_name)
+{
+    std::cout << "benchmark_codec" << std::endl;
+
+    std::ifstream file(file_name, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const size_t page_size = perfometer::records_cache_size;
+    const size_t num_pages = data.size() / page_size;
+
+    std::vector<uint8_t> compressed(perfometer::compression::max_compressed_size(page_size) * num_pages);
+    std::vector<size_t> compressed_sizes(num_pages);
+    std::vector<uint8_t> decompressed(page_size);
+
+    size_t total_compressed = 0;
+
+    perfometer::time start = perfometer::get_time();
+    for (int i = 0; i < codec_iterations; ++i)
+    {
+        total_compressed = 0;
+        for (size_t p = 0; p < num_pages; ++p)
+        {
+            compressed_sizes[p] = perfometer::compression::compress(&data[p * page_size], page_size,
+                                                                    &compressed[total_compressed],
+                                                                    compressed.size() - total_compressed);
+            total_compressed += compressed_sizes[p];
+        }
+    }
+    perfometer::time compress_time = perfometer::get_time() - start;
+
+    size_t mismatches = 0;
+
+    start = perfometer::get_time();
+    for (int i = 0; i < codec_iterations; ++i)
+    {
+        size_t offset = 0;
+        for (size_t p = 0; p < num_pages; ++p)
+        {
+            if (perfometer::compression::decompress(&compressed[offset], compressed_sizes[p],
+                                                    decompressed.data(), page_size) != page_size)
+            {
+                mismatches++;
+            }
+
+            offset += compressed_sizes[p];
+        }
+    }
+    perfometer::time decompress_time = perfometer::get_time() - start;
+
+    const double frequency = static_cast<double>(perfometer::get_clock_frequency());
+    const double megabytes = static_cast<double>(num_pages * page_size * codec_iterations) / (1024 * 1024);
+
+    std::cout << num_pages << " pages, ratio "
+              << static_cast<double>(num_pages * page_size) / total_compressed << std::endl;
+    std::cout << "compress " << megabytes / (compress_time / frequency) << " MB/s" << std::endl;
+    std::cout << "decompress " << megabytes / (decompress_time / frequency) << " MB/s" << std::endl;
+
+    if (mismatches)
+    {
+        std::cout << "failed to decompress " << mismatches << " pages" << std::endl;
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    size_t uncompressed = benchmark_workload("benchmark_compression.report", false);
+    size_t compressed = benchmark_workload("benchmark_compression_lz.report", true);
+
+    std::cout << "report size ratio " << static_cast<double>(uncompressed) / compressed << std::endl;
+
+    benchmark_codec("benchmark_compression.report");
+
+    return 0;
+}
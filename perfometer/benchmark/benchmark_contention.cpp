@@ -0,0 +1,275 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include "../src/record_buffer.h"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <utils/time.h>
+#include <utils/timer.h>
+
+// Compares handing off pages from many producer threads to single consumer thread
+// through mutex guarded std::queue (as perfometer did before) and lock free mpsc_queue,
+// then measures logging from many threads through perfometer itself
+
+constexpr size_t num_threads = 64;
+constexpr size_t pushes_per_thread = 10000;
+constexpr size_t pages_per_thread = 64;    // recycled once consumer popped them
+constexpr size_t records_per_thread = 100000;
+
+struct locked_queue
+{
+    void push(std::shared_ptr<perfometer::record_buffer> buffer)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        m_queue.push(std::move(buffer));
+    }
+
+    std::shared_ptr<perfometer::record_buffer> pop()
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+        std::shared_ptr<perfometer::record_buffer> buffer;
+        if (!m_queue.empty())
+        {
+            buffer = std::move(m_queue.front());
+            m_queue.pop();
+        }
+
+        return buffer;
+    }
+
+    std::recursive_mutex m_mutex;
+    std::queue<std::shared_ptr<perfometer::record_buffer>> m_queue;
+};
+
+struct lock_free_queue
+{
+    void push(perfometer::record_buffer* buffer)
+    {
+        m_queue.push(buffer);
+    }
+
+    perfometer::record_buffer* pop()
+    {
+        return m_queue.pop();
+    }
+
+    perfometer::mpsc_queue<perfometer::record_buffer> m_queue;
+};
+
+void print_latency(const char* name, std::vector<perfometer::time>& latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+
+    const double frequency = static_cast<double>(perfometer::get_clock_frequency());
+    auto percentile = [&](double p)
+    {
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * p));
+        return perfometer::utils::time_to_string(latencies[index] / frequency);
+    };
+
+    std::cout << name
+              << " p50 " << percentile(0.5)
+              << " p99 " << percentile(0.99)
+              << " p99.9 " << percentile(0.999)
+              << " max " << perfometer::utils::time_to_string(latencies.back() / frequency)
+              << std::endl;
+}
+
+perfometer::record_buffer* page_pointer(perfometer::record_buffer* page)
+{
+    return page;
+}
+
+perfometer::record_buffer* page_pointer(const std::shared_ptr<perfometer::record_buffer>& page)
+{
+    return page.get();
+}
+
+// producer pushes its few preallocated pages over and over, each once consumer popped it,
+// waiting for page is not measured, so only the handoff itself is
+template<typename Queue, typename Page>
+void benchmark_handoff(const char* name, perfometer::record_buffer* storage, std::vector<Page>& pages)
+{
+    std::cout << name << std::endl;
+
+    Queue queue;
+    std::atomic<size_t> popped(0);
+    std::vector<std::vector<perfometer::time>> latencies(num_threads);
+
+    std::unique_ptr<std::atomic<bool>[]> page_free(new std::atomic<bool>[pages.size()]);
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        page_free[i] = true;
+    }
+
+    {
+        perfometer::utils::logging_timer timer;
+
+        std::thread consumer([&]()
+        {
+            while (popped < num_threads * pushes_per_thread)
+            {
+                if (auto page = queue.pop())
+                {
+                    page_free[page_pointer(page) - storage].store(true, std::memory_order_release);
+                    popped++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        std::vector<std::thread> producers;
+        for (size_t i = 0; i < num_threads; ++i)
+        {
+            producers.emplace_back([&, i]()
+            {
+                latencies[i].reserve(pushes_per_thread);
+
+                for (size_t push = 0; push < pushes_per_thread; ++push)
+                {
+                    const size_t index = i * pages_per_thread + push % pages_per_thread;
+
+                    while (!page_free[index].load(std::memory_order_acquire))
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    page_free[index].store(false, std::memory_order_relaxed);
+
+                    perfometer::time start = perfometer::get_time();
+                    queue.push(pages[index]);
+                    latencies[i].push_back(perfometer::get_time() - start);
+                }
+            });
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+
+        consumer.join();
+    }
+
+    std::vector<perfometer::time> all;
+    for (auto& thread_latencies : latencies)
+    {
+        all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+
+    print_latency("push latency", all);
+}
+
+void benchmark_locked_queue()
+{
+    std::unique_ptr<perfometer::record_buffer[]> storage(new perfometer::record_buffer[num_threads * pages_per_thread]);
+
+    // pages stay owned by storage, queue still copies shared pointers as it did
+    std::vector<std::shared_ptr<perfometer::record_buffer>> pages;
+    for (size_t i = 0; i < num_threads * pages_per_thread; ++i)
+    {
+        pages.emplace_back(&storage[i], [](perfometer::record_buffer*) {});
+    }
+
+    benchmark_handoff<locked_queue>("benchmark_locked_queue", storage.get(), pages);
+}
+
+void benchmark_lock_free_queue()
+{
+    std::unique_ptr<perfometer::record_buffer[]> storage(new perfometer::record_buffer[num_threads * pages_per_thread]);
+
+    std::vector<perfometer::record_buffer*> pages;
+    for (size_t i = 0; i < num_threads * pages_per_thread; ++i)
+    {
+        pages.push_back(&storage[i]);
+    }
+
+    benchmark_handoff<lock_free_queue>("benchmark_lock_free_queue", storage.get(), pages);
+}
+
+void benchmark_logging()
+{
+    std::cout << "benchmark_logging" << std::endl;
+
+    perfometer::initialize("benchmark_contention.report");
+
+    const perfometer::string_id record_id = perfometer::register_string("record");
+    std::vector<std::vector<perfometer::time>> latencies(num_threads);
+
+    {
+        perfometer::utils::logging_timer timer;
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i)
+        {
+            threads.emplace_back([&, i]()
+            {
+                PERFOMETER_LOG_THREAD_NAME("WORKER");
+
+                latencies[i].reserve(records_per_thread);
+
+                for (size_t r = 0; r < records_per_thread; ++r)
+                {
+                    perfometer::time start = perfometer::get_time();
+                    perfometer::log_work(record_id, start, start + 1);
+                    latencies[i].push_back(perfometer::get_time() - start);
+                }
+
+                perfometer::flush_thread_cache();
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        perfometer::shutdown();
+    }
+
+    std::vector<perfometer::time> all;
+    for (auto& thread_latencies : latencies)
+    {
+        all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+
+    print_latency("log_work latency", all);
+}
+
+int main(int argc, const char** argv)
+{
+    benchmark_locked_queue();
+    benchmark_lock_free_queue();
+    benchmark_logging();
+
+    return 0;
+}
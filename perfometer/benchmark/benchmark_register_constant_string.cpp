@@ -68,6 +68,39 @@ void benchmark_strlen()
     }
 }
 
+void registered_scope()
+{
+    PERFOMETER_LOG_WORK_SCOPE("registered_scope");
+}
+
+void benchmark_registered_scope()
+{
+    std::cout << "benchmark_registered_scope" << std::endl;
+    perfometer::utils::logging_timer timer;
+
+    for (size_t i = 0; i < 1000000; ++i)
+    {
+        registered_scope();
+    }
+}
+
+#if defined(PERFOMETER_STATIC_STRINGS)
+void static_scope()
+{
+    PERFOMETER_LOG_STATIC_WORK_SCOPE("static_scope");
+}
+
+void benchmark_static_scope()
+{
+    std::cout << "benchmark_static_scope" << std::endl;
+    perfometer::utils::logging_timer timer;
+
+    for (size_t i = 0; i < 1000000; ++i)
+    {
+        static_scope();
+    }
+}
+#endif
 
 int main(int argc, const char** argv)
 {
@@ -81,6 +114,11 @@ int main(int argc, const char** argv)
     //benchmark_simple_registration();
 
     benchmark_strlen();
+
+    benchmark_registered_scope();
+#if defined(PERFOMETER_STATIC_STRINGS)
+    benchmark_static_scope();
+#endif
     
     perfometer::shutdown();
 
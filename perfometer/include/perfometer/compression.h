@@ -0,0 +1,285 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+// LZ4 block compatible compression of record pages, header only so both perfometer
+// and report reader share the same codec without external dependencies.
+// Block is a sequence of token, literals, 16 bit offset and match length extension,
+// last sequence carries only literals. Blocks are limited to 64 KB, page size is 16 bit.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace perfometer
+{
+namespace compression
+{
+    constexpr size_t max_block_size = 0xFFFF;
+    constexpr size_t min_match = 4;
+    constexpr size_t last_literals = 5;     // block always ends with at least 5 literals
+    constexpr size_t match_find_limit = 12; // last match starts at least 12 bytes before end
+    constexpr size_t hash_bits = 12;
+
+    constexpr size_t max_compressed_size(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    inline uint32_t read32(const uint8_t* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - hash_bits);
+    }
+
+    // writes length extension bytes for length which did not fit into token nibble
+    inline bool write_length(uint8_t*& out, const uint8_t* out_end, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            if (out == out_end)
+            {
+                return false;
+            }
+
+            *out++ = 255;
+        }
+
+        if (out == out_end)
+        {
+            return false;
+        }
+
+        *out++ = static_cast<uint8_t>(length);
+
+        return true;
+    }
+
+    inline bool write_sequence(uint8_t*& out, const uint8_t* out_end,
+                               const uint8_t* literals, size_t num_literals,
+                               size_t offset, size_t match_length)
+    {
+        if (out == out_end)
+        {
+            return false;
+        }
+
+        uint8_t& token = *out++;
+        token = static_cast<uint8_t>(num_literals < 15 ? num_literals << 4 : 0xF0);
+
+        if (num_literals >= 15 && !write_length(out, out_end, num_literals - 15))
+        {
+            return false;
+        }
+
+        if (static_cast<size_t>(out_end - out) < num_literals)
+        {
+            return false;
+        }
+
+        std::memcpy(out, literals, num_literals);
+        out += num_literals;
+
+        if (match_length == 0)
+        {
+            return true; // last sequence
+        }
+
+        if (out_end - out < 2)
+        {
+            return false;
+        }
+
+        *out++ = static_cast<uint8_t>(offset);
+        *out++ = static_cast<uint8_t>(offset >> 8);
+
+        const size_t length = match_length - min_match;
+        token |= static_cast<uint8_t>(length < 15 ? length : 15);
+
+        return length < 15 || write_length(out, out_end, length - 15);
+    }
+
+    // returns compressed size, 0 if input is too large or output does not fit into capacity
+    inline size_t compress(const uint8_t* data, size_t size, uint8_t* output, size_t capacity)
+    {
+        if (size > max_block_size)
+        {
+            return 0;
+        }
+
+        uint16_t table[1 << hash_bits] = {};
+
+        const uint8_t* in = data;
+        const uint8_t* in_end = data + size;
+        const uint8_t* anchor = data;
+        uint8_t* out = output;
+        const uint8_t* out_end = output + capacity;
+
+        if (size > match_find_limit)
+        {
+            const uint8_t* match_limit = in_end - match_find_limit;
+            const uint8_t* extend_limit = in_end - last_literals;
+            size_t misses = 0;
+
+            while (in < match_limit)
+            {
+                const uint32_t sequence = read32(in);
+                uint16_t& entry = table[hash(sequence)];
+                const uint8_t* candidate = data + entry;
+                entry = static_cast<uint16_t>(in - data);
+
+                if (candidate >= in || read32(candidate) != sequence)
+                {
+                    // skip faster through data which does not compress
+                    in += 1 + (misses++ >> 6);
+                    continue;
+                }
+
+                misses = 0;
+
+                size_t length = min_match;
+                while (in + length < extend_limit && candidate[length] == in[length])
+                {
+                    ++length;
+                }
+
+                if (!write_sequence(out, out_end, anchor, in - anchor, in - candidate, length))
+                {
+                    return 0;
+                }
+
+                in += length;
+                anchor = in;
+            }
+        }
+
+        if (!write_sequence(out, out_end, anchor, in_end - anchor, 0, 0))
+        {
+            return 0;
+        }
+
+        return out - output;
+    }
+
+    // returns decompressed size, 0 if block is malformed or does not fit into capacity
+    inline size_t decompress(const uint8_t* data, size_t size, uint8_t* output, size_t capacity)
+    {
+        const uint8_t* in = data;
+        const uint8_t* in_end = data + size;
+        uint8_t* out = output;
+        uint8_t* out_end = output + capacity;
+
+        auto read_length = [&](size_t& length) -> bool
+        {
+            uint8_t byte = 255;
+            while (byte == 255)
+            {
+                if (in == in_end)
+                {
+                    return false;
+                }
+
+                byte = *in++;
+                length += byte;
+            }
+
+            return true;
+        };
+
+        while (in < in_end)
+        {
+            const uint8_t token = *in++;
+
+            size_t num_literals = token >> 4;
+            if (num_literals == 15 && !read_length(num_literals))
+            {
+                return 0;
+            }
+
+            if (static_cast<size_t>(in_end - in) < num_literals ||
+                static_cast<size_t>(out_end - out) < num_literals)
+            {
+                return 0;
+            }
+
+            std::memcpy(out, in, num_literals);
+            in += num_literals;
+            out += num_literals;
+
+            if (in == in_end)
+            {
+                break; // last sequence
+            }
+
+            if (in_end - in < 2)
+            {
+                return 0;
+            }
+
+            const size_t offset = in[0] | (in[1] << 8);
+            in += 2;
+
+            if (offset == 0 || offset > static_cast<size_t>(out - output))
+            {
+                return 0;
+            }
+
+            size_t length = token & 0x0F;
+            if (length == 15 && !read_length(length))
+            {
+                return 0;
+            }
+
+            length += min_match;
+
+            if (static_cast<size_t>(out_end - out) < length)
+            {
+                return 0;
+            }
+
+            // match may overlap output being written, then it is copied byte by byte
+            const uint8_t* match = out - offset;
+            if (offset >= length)
+            {
+                std::memcpy(out, match, length);
+            }
+            else
+            {
+                for (size_t i = 0; i < length; ++i)
+                {
+                    out[i] = match[i];
+                }
+            }
+
+            out += length;
+        }
+
+        return out - output;
+    }
+
+} // namespace compression
+} // namespace perfometer
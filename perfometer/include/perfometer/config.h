@@ -0,0 +1,45 @@
+/* Copyright 2020-2021 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <perfometer/time.h>
+#include <perfometer/thread.h>
+
+//#define PERFOMETER_LOG_RECORD_SWAP_OVERHEAD
+
+namespace perfometer
+{
+    constexpr uint8_t major_version = 2;
+    constexpr uint8_t minor_version = 5;
+    constexpr uint8_t patch_version = 0;
+
+    constexpr size_t records_cache_size = 4048;
+    // this buf in bytes + some control data to fit 4K page overral
+
+    constexpr size_t max_string_length = 1024;
+    // longer registered and dynamic strings are truncated, so string record fits into page
+
+    using string_id = uint32_t;
+
+} // namespace perfometer
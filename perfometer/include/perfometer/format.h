@@ -21,6 +21,7 @@ SOFTWARE. */
 #pragma once
 
 #include <perfometer/config.h>
+#include <cstring>
 #include <iostream>
 #include <limits>
 
@@ -31,8 +32,8 @@ namespace format
     const char header[] = "PERFOMETER.";    // PERFOMETER.VER - VER is version composed from
                                             // major minor and patch versions one byte each
 
-    constexpr uint8_t major_version = 2;
-    constexpr uint8_t minor_version = 0;
+    constexpr uint8_t major_version = 5;
+    constexpr uint8_t minor_version = 4;
     constexpr uint8_t patch_version = 0;
 
     enum record_type : uint8_t
@@ -49,42 +50,201 @@ namespace format
                                     // thread id size initialization thread id
 
         string = 3,                 // 8 bit record type
-                                    // 16 bit string id
-                                    // 8 bit string length
+                                    // varint string id (up until 4.x.x 16 bit string id)
+                                    // varint string length (up until 5.0.x 8 bit)
                                     // string length size string data
 
         thread_name = 4,            // 8 bit record type
                                     // thread id size thread id
-                                    // 16 bit string id
+                                    // varint string id (up until 4.x.x 16 bit string id)
 
         work = 5,                   // 8 bit record type
-                                    // 16 bit name string id
-                                    // time size time start
-                                    // time size time end
-                                    // thread id size thread id
+                                    // varint name string id (up until 4.x.x 16 bit)
+                                    // varint zigzag time start delta to previous record time in page
+                                    // varint duration
+                                    // thread id is taken from page
+                                    // (up until 3.x.x time size time start, time size time end,
+                                    // up until 2.x.x followed by thread id size thread id)
 
         event = 6,                  // 8 bit record type
-                                    // 16 bit name string id
-                                    // time size time
-                                    // thread id size thread id
+                                    // varint name string id (up until 4.x.x 16 bit)
+                                    // varint zigzag time delta to previous record time in page
+                                    // thread id is taken from page
+                                    // (up until 3.x.x time size time,
+                                    // up until 2.x.x followed by thread id size thread id)
 
-        wait = 7,                   // 8 bit record type
-                                    // 16 bit name string id
-                                    // time size time start
-                                    // time size time end
-                                    // thread id size thread id
+        wait = 7,                   // 8 bit record type, same layout as work
 
         page = 8,                   // 8 bit record type
                                     // 16 bit page size
-                                    // thread id size thread id
+                                    // thread id size thread id, owner of page records
+                                    // time size page base time, previous record time
+                                    // for the first record of page (since 4.0.0)
+
+        page_end = 9,               // 8 bit record type
+
+        page_compressed = 10,       // 8 bit record type
+                                    // 16 bit compressed size
+                                    // 16 bit page size
+                                    // compressed size page data compressed by
+                                    // perfometer/compression.h, once decompressed
+                                    // same as page record contents (since 4.1.0)
+
+        suppressed = 11,            // 8 bit record type
+                                    // varint name string id
+                                    // varint number of records of the name dropped by
+                                    // sampling or rate limit on page thread since previous
+                                    // suppressed record of the name (since 4.2.0)
+
+        dynamic_string = 12,        // 8 bit record type
+                                    // varint transient id
+                                    // varint string length
+                                    // string length size string data
+                                    // binds string to transient id of page thread and makes it
+                                    // name of next record with dynamic_string_id (since 5.1.0)
+
+        dynamic_string_ref = 13,    // 8 bit record type
+                                    // varint transient id
+                                    // makes string bound to transient id of page thread name of
+                                    // next record with dynamic_string_id (since 5.1.0)
 
-        page_end = 9                // 8 bit record type
+        counter = 14,               // 8 bit record type
+                                    // varint name string id
+                                    // varint zigzag time delta to previous record time in page
+                                    // varint zigzag 64 bit integer value (since 5.2.0)
+
+        gauge = 15,                 // 8 bit record type
+                                    // varint name string id
+                                    // varint zigzag time delta to previous record time in page
+                                    // 64 bit IEEE 754 double value (since 5.2.0)
+
+        flow_begin = 16,            // 8 bit record type
+                                    // varint name string id
+                                    // varint zigzag time delta to previous record time in page
+                                    // varint flow id, shared by records of the flow on any
+                                    // thread (since 5.3.0)
+
+        flow_step = 17,             // 8 bit record type, same layout as flow_begin
+
+        flow_end = 18,              // 8 bit record type, same layout as flow_begin
+
+        arguments = 19              // 8 bit record type
+                                    // 8 bit argument count
+                                    // for each argument
+                                    //     8 bit perfometer::argument_type
+                                    //     varint argument name string id
+                                    //     varint zigzag integer, 64 bit IEEE 754 double
+                                    //     or varint string id value
+                                    // attached to preceding work, wait or event record
+                                    // of the page (since 5.4.0)
     };
 
     constexpr string_id invalid_string_id = std::numeric_limits<string_id>::max();
     constexpr string_id unknown_string_id = 0;
     constexpr string_id dynamic_string_id = 1;
 
+    // registered string ids are counted up from 2 below static_string_id_base,
+    // ids of static strings are hashes of name and source location at or above it
+    constexpr string_id static_string_id_base = 0x80000000;
+
+    // varint is little endian base 128, 7 bits per byte, high bit set if more bytes follow
+    // zigzag maps signed to unsigned so small negative deltas stay short: 0, -1, 1, -2 -> 0, 1, 2, 3
+    constexpr size_t max_varint_size = 10;
+
+    inline uint64_t zigzag_encode(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t zigzag_decode(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // reads varint from at most size bytes, returns number of bytes read, 0 if incomplete
+    inline size_t read_varint(const uint8_t* data, size_t size, uint64_t& value)
+    {
+        value = 0;
+
+        for (size_t i = 0; i < size && i < max_varint_size; ++i)
+        {
+            value |= static_cast<uint64_t>(data[i] & 0x7f) << (7 * i);
+
+            if ((data[i] & 0x80) == 0)
+            {
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    // header followed by major, minor and patch version bytes
+    constexpr size_t header_size = sizeof(header) - 1 + 3;
+
+    // records written outside of pages by current version
+    inline bool top_level_record(record_type type)
+    {
+        return type == clock_configuration || type == thread_info || type == string ||
+               type == thread_name || type == page || type == page_compressed;
+    }
+
+    // size of top level record of current version at data, page sizes include page_end record
+    // following page data; 0 if size bytes do not hold whole record; thread id size is the one
+    // of thread_info record of the report
+    inline size_t top_level_record_size(const uint8_t* data, size_t size, size_t thread_id_size)
+    {
+        if (size < 1)
+        {
+            return 0;
+        }
+
+        size_t record_size = 0;
+        uint64_t value = 0;
+
+        switch (data[0])
+        {
+            case clock_configuration:
+                record_size = size < 2 ? 0 : 2 + 2 * size_t(data[1]);
+                break;
+            case thread_info:
+                record_size = size < 2 ? 0 : 2 + size_t(data[1]);
+                break;
+            case string:
+            {
+                size_t id_size = read_varint(data + 1, size - 1, value);
+                size_t length_size = id_size ? read_varint(data + 1 + id_size, size - 1 - id_size, value) : 0;
+                record_size = length_size && value < size ? 1 + id_size + length_size + value : 0;
+                break;
+            }
+            case thread_name:
+            {
+                size_t id_size = size > 1 + thread_id_size
+                               ? read_varint(data + 1 + thread_id_size, size - 1 - thread_id_size, value) : 0;
+                record_size = id_size ? 1 + thread_id_size + id_size : 0;
+                break;
+            }
+            case page:
+            case page_compressed:
+            {
+                uint16_t page_size = 0;
+                if (size >= 1 + sizeof(page_size))
+                {
+                    std::memcpy(&page_size, data + 1, sizeof(page_size));
+
+                    // compressed page has 16 bit uncompressed size after compressed one
+                    const size_t page_header = data[0] == page ? 1 + sizeof(page_size) : 1 + 2 * sizeof(page_size);
+                    record_size = page_header + page_size + 1;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        return record_size <= size ? record_size : 0;
+    }
+
     inline std::ostream& operator << (std::ostream& stream, const record_type& type)
     {
         stream.write(reinterpret_cast<const char *>(&type), 1);
@@ -43,7 +43,8 @@ namespace perfometer
         {
             time end_time = get_time();
 
-            if (m_start_time != end_time )
+            if (m_start_time != end_time &&
+                end_time - m_start_time >= min_duration_threshold().load(std::memory_order_relaxed))
             {
                 functor(m_name, m_start_time, end_time);
             }
@@ -54,6 +55,45 @@ namespace perfometer
         time m_start_time;
     };
 
+    using log_arguments_functor = result (*)(string_id, time, time, const argument*, size_t);
+
+    // scope_log which attaches arguments added during the scope, e.g. size of the processed batch
+    template <log_arguments_functor functor>
+    class scope_log_with_arguments
+    {
+    public:
+        scope_log_with_arguments(string_id s_id)
+            : m_name(s_id)
+        {
+            m_start_time = get_time();
+        }
+
+        ~scope_log_with_arguments()
+        {
+            time end_time = get_time();
+
+            if (m_start_time != end_time &&
+                end_time - m_start_time >= min_duration_threshold().load(std::memory_order_relaxed))
+            {
+                functor(m_name, m_start_time, end_time, m_arguments, m_count);
+            }
+        }
+
+        void add(const argument& arg)
+        {
+            if (m_count < max_arguments)
+            {
+                m_arguments[m_count++] = arg;
+            }
+        }
+
+    private:
+        string_id m_name;
+        time m_start_time;
+        argument m_arguments[max_arguments];
+        size_t m_count = 0;
+    };
+
     inline const char* string_adapter(const char* string)
     {
         return string;
@@ -113,5 +153,123 @@ namespace perfometer
         perfometer::log_event(perfometer::write_string(PERFOMETER_STRING_ADAPTER(name)),    \
                               perfometer::get_time())
 
+#define PERFOMETER_LOG_COUNTER(name, value)                                                 \
+        PERFOMETER_REGISTER_STRING(name);                                                   \
+        perfometer::log_counter(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), value)
+
+#define PERFOMETER_LOG_GAUGE(name, value)                                                   \
+        PERFOMETER_REGISTER_STRING(name);                                                   \
+        perfometer::log_gauge(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), value)
+
+#define PERFOMETER_LOG_FLOW_BEGIN(name, flow_id)                                            \
+        PERFOMETER_REGISTER_STRING(name);                                                   \
+        perfometer::log_flow_begin(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), flow_id)
+
+#define PERFOMETER_LOG_FLOW_STEP(name, flow_id)                                             \
+        PERFOMETER_REGISTER_STRING(name);                                                   \
+        perfometer::log_flow_step(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), flow_id)
+
+#define PERFOMETER_LOG_FLOW_END(name, flow_id)                                              \
+        PERFOMETER_REGISTER_STRING(name);                                                   \
+        perfometer::log_flow_end(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), flow_id)
+
 #define PERFOMETER_LOG_WORK_FUNCTION()      PERFOMETER_LOG_WORK_SCOPE(PERFOMETER_FUNCTION)
 #define PERFOMETER_LOG_WAIT_FUNCTION()      PERFOMETER_LOG_WAIT_SCOPE(PERFOMETER_FUNCTION)
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#   define PERFOMETER_STATIC_STRINGS
+#   include <perfometer/format.h>
+#   include <string_view>
+#endif
+
+#if defined(PERFOMETER_STATIC_STRINGS)
+namespace perfometer
+{
+    // FNV-1a
+    constexpr uint32_t string_hash(std::string_view string, uint32_t hash = 2166136261u)
+    {
+        for (char c : string)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+
+        return hash;
+    }
+
+    // id of static string, hash of name and source location above registered string ids
+    constexpr string_id static_string_id(std::string_view name, std::string_view file, uint32_t line)
+    {
+        const uint32_t hash = string_hash(file, string_hash(name)) ^ (line * 2654435761u);
+        const string_id id = format::static_string_id_base | hash;
+
+        return id == format::invalid_string_id ? id - 1 : id;
+    }
+
+    // Name is local type describing macro call site, its node is constant initialized with id
+    // computed at compile time and registered once on static initialization, which moves id
+    // taken by other name, so logging reads id with neither guard nor registration
+    template <typename Name>
+    struct static_string
+    {
+        struct registrar
+        {
+            registrar()
+            {
+                register_static_string(s_node);
+            }
+        };
+
+        static string_id id()
+        {
+            static_cast<void>(&s_registrar);
+            return s_node.id;
+        }
+
+        static static_string_node s_node;
+        static registrar s_registrar;
+    };
+
+    template <typename Name>
+    static_string_node static_string<Name>::s_node = { static_string_id(Name::name(), Name::file(), Name::line()),
+                                                        Name::name().data(), Name::name().size(), nullptr };
+
+    template <typename Name>
+    typename static_string<Name>::registrar static_string<Name>::s_registrar;
+}
+
+#define PERFOMETER_STATIC_STRING(string)                                                    \
+        static constexpr std::string_view PERFOMETER_UNIQUE(s_name) = string;               \
+        struct PERFOMETER_UNIQUE(s_name_t)                                                  \
+        {                                                                                   \
+            static constexpr std::string_view name() { return PERFOMETER_UNIQUE(s_name); }  \
+            static constexpr std::string_view file() { return __FILE__; }                   \
+            static constexpr uint32_t line() { return __LINE__; }                           \
+        };                                                                                  \
+        const perfometer::string_id PERFOMETER_UNIQUE(s_id) =                               \
+            perfometer::static_string<PERFOMETER_UNIQUE(s_name_t)>::id()                    \
+
+#define PERFOMETER_LOG_STATIC_WORK_SCOPE(name)                                              \
+        PERFOMETER_STATIC_STRING(name);                                                     \
+        perfometer::scope_log<perfometer::log_work>                                         \
+            PERFOMETER_UNIQUE(logger)(PERFOMETER_UNIQUE(s_id))
+
+#define PERFOMETER_LOG_STATIC_WAIT_SCOPE(name)                                              \
+        PERFOMETER_STATIC_STRING(name);                                                     \
+        perfometer::scope_log<perfometer::log_wait>                                         \
+            PERFOMETER_UNIQUE(logger)(PERFOMETER_UNIQUE(s_id))
+
+#define PERFOMETER_LOG_STATIC_EVENT(name)                                                   \
+        PERFOMETER_STATIC_STRING(name);                                                     \
+        perfometer::log_event(PERFOMETER_UNIQUE(s_id), perfometer::get_time())
+
+#define PERFOMETER_LOG_STATIC_COUNTER(name, value)                                          \
+        PERFOMETER_STATIC_STRING(name);                                                     \
+        perfometer::log_counter(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), value)
+
+#define PERFOMETER_LOG_STATIC_GAUGE(name, value)                                            \
+        PERFOMETER_STATIC_STRING(name);                                                     \
+        perfometer::log_gauge(PERFOMETER_UNIQUE(s_id), perfometer::get_time(), value)
+
+#define PERFOMETER_LOG_STATIC_WORK_FUNCTION()   PERFOMETER_LOG_STATIC_WORK_SCOPE(PERFOMETER_FUNCTION)
+#define PERFOMETER_LOG_STATIC_WAIT_FUNCTION()   PERFOMETER_LOG_STATIC_WAIT_SCOPE(PERFOMETER_FUNCTION)
+#endif
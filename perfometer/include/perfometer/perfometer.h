@@ -21,6 +21,7 @@ SOFTWARE. */
 #pragma once
 
 #include <perfometer/config.h>
+#include <atomic>
 
 namespace perfometer
 {
@@ -39,7 +40,85 @@ namespace perfometer
         newer_format
     };
 
+    enum class file_sync
+    {
+        none,           // written data reaches disk whenever OS decides
+        on_flush,       // fdatasync on flush() and shutdown()
+        every_write     // fdatasync after every batch written to file
+    };
+
+    enum class fork_policy
+    {
+        stop,           // logging stops in child process, parent process keeps the report
+        new_report      // child process writes own report named after parent one with .<pid> suffix
+    };
+
+    class sink;
+
+    struct configuration
+    {
+        const char* file_name = "perfometer.report";
+
+        // report goes to sink instead of file when set, see perfometer/sink.h,
+        // sink must outlive session, crash handler and fork_policy::new_report do not apply
+        sink* report_sink = nullptr;
+
+        bool running = true;
+
+        // logger thread sleeps while idle and wakes up at least once per this period
+        uint32_t logger_max_latency_ms = 100;
+
+        // number of queued pages which wakes up logger thread before period ends
+        size_t logger_wakeup_pages = 16;
+
+        // logger takes partial pages of threads which did not fill them within this age,
+        // bounding delay of records reaching report from quiet threads, 0 - disabled
+        uint32_t page_max_age_ms = 0;
+
+        // bytes of record pages preallocated on initialize, records are dropped while all pages
+        // are in use, 0 - pages allocated on demand; bounds record pages only, per thread state
+        // such as dynamic string cache, sampling counters and counter values is allocated on
+        // first use by thread
+        size_t memory_budget = 0;
+
+        // compress pages on logger thread, pages which do not shrink are written as is
+        bool compression = false;
+
+        // report file writing, Linux only: size of batches pages are collected into before written,
+        // file opened with O_DIRECT bypassing page cache if supported, sync policy;
+        // batch size applies to report sink on every platform
+        size_t write_batch_size = 1024 * 1024;
+        bool direct_io = false;
+        file_sync sync = file_sync::none;
+
+        // report file is continued in next one once it holds rotate_size bytes or rotate_interval_ms
+        // passed since it was started, 0 - disabled; segments after the first one are named
+        // <file_name>.1, <file_name>.2 and so on, each starts with header, registered strings and
+        // thread names and is read on its own; not with report sink or in flight recorder mode
+        size_t rotate_size = 0;
+        uint32_t rotate_interval_ms = 0;
+
+        // flight recorder mode, last N pages are kept in memory instead of written to file
+        // and saved on demand by dump(), ring pages are taken from memory budget, which has
+        // to hold more pages than ring, 0 - disabled
+        size_t flight_recorder_pages = 0;
+
+        // counter and gauge values equal to previous value of the name logged by the thread
+        // are not written, reader keeps showing the previous value
+        bool skip_unchanged_counters = false;
+
+        // on SIGSEGV, SIGBUS and SIGABRT pages in progress and pages queued for logger are written
+        // to report file before previous handler runs, Linux only, not in flight recorder mode
+        bool crash_handler = false;
+
+        // what child process does when forked after initialize, Linux only; fork() handler only
+        // stops session, state of parent process is dropped and new report started by the first
+        // call into session in child process
+        fork_policy on_fork = fork_policy::stop;
+    };
+
     result initialize(const char file_name[] = "perfometer.report", bool running = true);
+    result initialize(const configuration& config);
     result shutdown();
 
     result pause();
@@ -48,11 +127,30 @@ namespace perfometer
     result flush_thread_cache();
     result flush();
 
+    // writes flight recorder pages into report file, pages not yet handed over to logger
+    // by other threads are not included, returns invalid_arguments if not in flight recorder mode
+    result dump(const char file_name[]);
+
     // register static reusable string, returns assigned string id, up until string_id::max
     string_id register_string(const char* string);
     string_id register_string(const char* string, size_t len);
 
-    // writes string id without registration, to be used once, returns format::dynamic_string_id
+    // string with id known at compile time, see PERFOMETER_LOG_STATIC_* macros in helpers.h
+    // nodes are static objects registered on static initialization and written to every report,
+    // registration moves id of node to the next free one if node of other name has it
+    struct static_string_node
+    {
+        string_id id;
+        const char* name;
+        size_t length;
+        static_string_node* next;
+    };
+
+    void register_static_string(static_string_node& node);
+
+    // writes string without registration to name the next record of the thread, returns
+    // format::dynamic_string_id, or format::invalid_string_id if not running or out of pages,
+    // recently written strings are written as short references
     string_id write_string(const char* string, size_t len);
 
     result log_thread_name(string_id str_id, thread_id t_id);
@@ -63,4 +161,151 @@ namespace perfometer
 
     result log_event(string_id str_id, time t);
 
+    enum class argument_type : uint8_t
+    {
+        integer,    // int64_t
+        real,       // double
+        string      // registered string id
+    };
+
+    constexpr size_t max_arguments = 8;
+
+    // named typed value attached to work, wait or event record, e.g. batch size
+    struct argument
+    {
+        static argument integer(string_id name, int64_t value)
+        {
+            argument arg{name, argument_type::integer, {}};
+            arg.value.integer = value;
+            return arg;
+        }
+
+        static argument real(string_id name, double value)
+        {
+            argument arg{name, argument_type::real, {}};
+            arg.value.real = value;
+            return arg;
+        }
+
+        static argument string(string_id name, string_id value)
+        {
+            argument arg{name, argument_type::string, {}};
+            arg.value.string = value;
+            return arg;
+        }
+
+        string_id name;
+        argument_type type;
+        union
+        {
+            int64_t integer;
+            double real;
+            string_id string;
+        } value;
+    };
+
+    // records with up to max_arguments arguments, written in the same page right after record
+    result log_work(string_id str_id, time start_time, time end_time, const argument* args, size_t count);
+    result log_wait(string_id str_id, time start_time, time end_time, const argument* args, size_t count);
+
+    result log_event(string_id str_id, time t, const argument* args, size_t count);
+
+    // numeric time series, integer counters such as queue depth and floating point gauges,
+    // sampling, rate limit and skip_unchanged_counters apply
+    result log_counter(string_id str_id, time t, int64_t value);
+    result log_gauge(string_id str_id, time t, double value);
+
+    // work passed between threads, records with same flow id are linked by reader regardless
+    // of thread they are logged on, new_flow_id() returns process unique id
+    uint64_t new_flow_id();
+
+    result log_flow_begin(string_id str_id, time t, uint64_t flow_id);
+    result log_flow_step(string_id str_id, time t, uint64_t flow_id);
+    result log_flow_end(string_id str_id, time t, uint64_t flow_id);
+
+    // keeps 1 of every ratio work, wait and event records of the name on each thread, 1 - keep all
+    result set_sampling(string_id str_id, uint32_t ratio);
+
+    // keeps at most rate records of the name per second over all threads allowing bursts
+    // of burst records, 0 - no limit; dropped records are counted in suppressed records
+    result set_rate_limit(string_id str_id, uint32_t rate, uint32_t burst = 1);
+
+    // work and wait records shorter than duration ticks are dropped before reaching page,
+    // for all names or for the name, 0 - keep all
+    result set_min_duration(time duration);
+    result set_min_duration(string_id str_id, time duration);
+
+    // global minimum duration, checked inline by scope_log before calling into library
+    inline std::atomic<time>& min_duration_threshold()
+    {
+        static std::atomic<time> s_min_duration(0);
+        return s_min_duration;
+    }
+
+    // sessions running at the same time, including default session
+    constexpr size_t max_sessions = 8;
+
+    struct session_state;
+
+    // collector writing own report through own page pool, page queue, logger thread and file,
+    // e.g. short detailed capture running alongside long sparse one; registered strings are
+    // shared by all sessions, free functions above log into default_session()
+    // initialize returns overflow once max_sessions sessions run
+    class session
+    {
+    public:
+        session();
+        ~session(); // shuts session down if running
+
+        session(const session&) = delete;
+        session& operator = (const session&) = delete;
+
+        result initialize(const char file_name[], bool running = true);
+        result initialize(const configuration& config);
+        result shutdown();
+
+        result pause();
+        result resume();
+
+        result flush_thread_cache();
+        result flush();
+
+        result dump(const char file_name[]);
+
+        string_id write_string(const char* string, size_t len);
+
+        result log_thread_name(string_id str_id, thread_id t_id);
+        result log_thread_name(string_id str_id);
+
+        result log_work(string_id str_id, time start_time, time end_time);
+        result log_wait(string_id str_id, time start_time, time end_time);
+        result log_work(string_id str_id, time start_time, time end_time, const argument* args, size_t count);
+        result log_wait(string_id str_id, time start_time, time end_time, const argument* args, size_t count);
+
+        result log_event(string_id str_id, time t);
+        result log_event(string_id str_id, time t, const argument* args, size_t count);
+
+        result log_counter(string_id str_id, time t, int64_t value);
+        result log_gauge(string_id str_id, time t, double value);
+
+        result log_flow_begin(string_id str_id, time t, uint64_t flow_id);
+        result log_flow_step(string_id str_id, time t, uint64_t flow_id);
+        result log_flow_end(string_id str_id, time t, uint64_t flow_id);
+
+        result set_sampling(string_id str_id, uint32_t ratio);
+        result set_rate_limit(string_id str_id, uint32_t rate, uint32_t burst = 1);
+        result set_min_duration(time duration);
+        result set_min_duration(string_id str_id, time duration);
+
+    private:
+        explicit session(session_state& state);
+
+        friend session& default_session();
+
+        session_state*  m_state;
+        bool            m_owned;
+    };
+
+    session& default_session();
+
 } // namespace perfometer
@@ -0,0 +1,138 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <perfometer/perfometer.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace perfometer
+{
+    // destination of report byte stream set by configuration::report_sink, receives batches
+    // of whole page frames collected up to configuration::write_batch_size, so there is one
+    // virtual call per batch, not per page; called by one thread at a time, mostly logger thread
+    class sink
+    {
+    public:
+        virtual ~sink() {}
+
+        virtual result write(const void* data, size_t size) = 0;
+
+        // data written so far should reach destination, called by flush() and shutdown()
+        virtual result flush() { return result::ok; }
+
+        // report is complete, called by shutdown()
+        virtual result close() { return result::ok; }
+    };
+
+    // writes report into file through std::ofstream
+    class file_sink : public sink
+    {
+    public:
+        explicit file_sink(const char file_name[]);
+
+        result write(const void* data, size_t size) override;
+        result flush() override;
+        result close() override;
+
+    private:
+        std::ofstream m_file;
+    };
+
+    // keeps report in memory for tests and in-process consumers, may be read while written
+    class memory_sink : public sink
+    {
+    public:
+        result write(const void* data, size_t size) override;
+
+        // copy of report written so far
+        std::vector<uint8_t> data() const;
+
+        // moves report bytes written since previous take() to the end of output,
+        // returns number of bytes moved
+        size_t take(std::vector<uint8_t>& output);
+
+    private:
+        std::vector<uint8_t> m_data;
+        mutable mutex m_mutex;
+    };
+
+#if !defined(_WIN32)
+    // writes report into file descriptor, e.g. write end of pipe to gzip or to analysis process,
+    // owned descriptor is closed by close(); writing into pipe with no reader raises SIGPIPE
+    // unless application ignores it
+    class fd_sink : public sink
+    {
+    public:
+        explicit fd_sink(int fd, bool owned = false);
+        ~fd_sink();
+
+        result write(const void* data, size_t size) override;
+        result close() override;
+
+    private:
+        int  m_fd;
+        bool m_owned;
+    };
+
+    // serves report on Unix domain socket at path, e.g. to visualizer --attach, any number
+    // of clients may connect at any time; clients are accepted when next batch is written and
+    // first receive report header, clock configuration, thread info, strings and thread names
+    // written so far, then batches as they are written, so late client reads valid report
+    // missing earlier pages and dynamic strings bound in them; strings and thread names are
+    // picked from pages as they pass, compressed pages are decompressed for that; client not
+    // taking data within send timeout is disconnected, so slow client never stalls logger
+    // thread for longer
+    class socket_sink : public sink
+    {
+    public:
+        explicit socket_sink(const char path[], uint32_t send_timeout_ms = 1000);
+        ~socket_sink();
+
+        // false if socket could not be created or bound to path
+        bool listening() const { return m_listener >= 0; }
+
+        result write(const void* data, size_t size) override;
+        result close() override;
+
+    private:
+        void accept_clients();
+        void catalog(const uint8_t* data, size_t size);
+        void catalog_page(const uint8_t* data, size_t size);
+        void send_to_clients(const uint8_t* data, size_t size);
+
+        std::string             m_path;
+        int                     m_listener;
+        uint32_t                m_send_timeout_ms;
+        std::vector<int>        m_clients;
+
+        // header, clock configuration, thread info, strings and thread names,
+        // sent to every client on connect
+        std::vector<uint8_t>    m_catalog;
+        std::vector<uint8_t>    m_page;
+        size_t                  m_time_size;
+        size_t                  m_thread_id_size;
+    };
+#endif
+
+} // namespace perfometer
@@ -22,11 +22,13 @@ SOFTWARE. */
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 
 namespace perfometer
 {
     using mutex = std::recursive_mutex;
     using scoped_lock = std::unique_lock<mutex>;
+    using condition_variable = std::condition_variable_any;
 
     using thread_id = std::thread::id;
 
@@ -0,0 +1,186 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+// Invariant TSC clock, replaces perfometer/time.h when built with -DPERFOMETER_TSC_CLOCK=ON
+// or -DOVERRIDE_TIME_H="<perfometer/time_tsc.h>"
+// Tick frequency is calibrated against system clock on first use, before any time is handed out,
+// perfometer::initialize() stores calibrated frequency in clock_configuration record.
+// Falls back to system clock if CPU has no invariant TSC or PERFOMETER_CLOCK=system is set.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#   define PERFOMETER_TSC_X86
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>
+#   include <cpuid.h>
+#   define PERFOMETER_TSC_X86
+#elif defined(__aarch64__)
+#   define PERFOMETER_TSC_ARM64
+#endif
+
+namespace perfometer
+{
+    using clock = std::chrono::time_point<std::chrono::high_resolution_clock>;
+    using time = clock::duration::rep;
+
+    struct tsc_clock_state
+    {
+        bool enabled;
+        time frequency;
+    };
+
+    inline time get_system_time()
+    {
+        return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    }
+
+    inline time read_tsc()
+    {
+#if defined(PERFOMETER_TSC_X86)
+        return static_cast<time>(__rdtsc());
+#elif defined(PERFOMETER_TSC_ARM64)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return static_cast<time>(ticks);
+#else
+        return get_system_time();
+#endif
+    }
+
+    inline bool invariant_tsc_supported()
+    {
+#if defined(PERFOMETER_TSC_X86)
+        unsigned int regs[4] = {};
+#   if defined(_MSC_VER)
+        __cpuid(reinterpret_cast<int*>(regs), 0x80000000);
+        if (regs[0] < 0x80000007)
+        {
+            return false;
+        }
+        __cpuid(reinterpret_cast<int*>(regs), 0x80000007);
+#   else
+        if (!__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]))
+        {
+            return false;
+        }
+#   endif
+        return (regs[3] & (1 << 8)) != 0;
+#elif defined(PERFOMETER_TSC_ARM64)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline tsc_clock_state calibrate_tsc_clock()
+    {
+        tsc_clock_state state{false, clock::period::den};
+
+        const char* source = std::getenv("PERFOMETER_CLOCK");
+        if ((source && std::strcmp(source, "system") == 0) || !invariant_tsc_supported())
+        {
+            return state;
+        }
+
+#if defined(PERFOMETER_TSC_ARM64)
+        uint64_t frequency;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+        state.frequency = static_cast<time>(frequency);
+#else
+        auto system_start = std::chrono::steady_clock::now();
+        time tsc_start = read_tsc();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        auto system_end = std::chrono::steady_clock::now();
+        time tsc_end = read_tsc();
+
+        std::chrono::duration<double> elapsed = system_end - system_start;
+        state.frequency = static_cast<time>((tsc_end - tsc_start) / elapsed.count());
+#endif
+
+        state.enabled = state.frequency > 0;
+        if (!state.enabled)
+        {
+            state.frequency = clock::period::den;
+        }
+
+        return state;
+    }
+
+    enum tsc_clock_source : int
+    {
+        clock_uncalibrated,
+        clock_tsc,
+        clock_system
+    };
+
+    // constant initialized globals, read by get_time() without static initialization guard,
+    // template keeps the definition in the header
+    template <typename T = void>
+    struct tsc_clock_global
+    {
+        static std::atomic<int> source;
+        static std::atomic<time> frequency;
+    };
+
+    template <typename T> std::atomic<int> tsc_clock_global<T>::source(clock_uncalibrated);
+    template <typename T> std::atomic<time> tsc_clock_global<T>::frequency(clock::period::den);
+
+    // calibrates once, threads calling meanwhile wait for it, frequency is published before source
+    inline int calibrate_clock()
+    {
+        static const tsc_clock_state s_state = calibrate_tsc_clock();
+
+        const int source = s_state.enabled ? clock_tsc : clock_system;
+
+        tsc_clock_global<>::frequency.store(s_state.frequency, std::memory_order_relaxed);
+        tsc_clock_global<>::source.store(source, std::memory_order_release);
+
+        return source;
+    }
+
+    inline int clock_source()
+    {
+        const int source = tsc_clock_global<>::source.load(std::memory_order_acquire);
+        return source != clock_uncalibrated ? source : calibrate_clock();
+    }
+
+    inline time get_clock_frequency()
+    {
+        clock_source();
+        return tsc_clock_global<>::frequency.load(std::memory_order_relaxed);
+    }
+
+    inline time get_time()
+    {
+        return clock_source() == clock_tsc ? read_tsc() : get_system_time();
+    }
+
+} // namespace perfometer
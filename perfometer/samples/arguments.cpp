@@ -0,0 +1,83 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+
+// Attach typed arguments to work and event records, e.g. to find out
+// size of the batch that made the scope slow
+
+void process_batch(const std::vector<int>& batch)
+{
+    static perfometer::string_id s_name_id = perfometer::register_string("process_batch");
+    static perfometer::string_id s_size_id = perfometer::register_string("batch size");
+    static perfometer::string_id s_first_id = perfometer::register_string("first item");
+
+    perfometer::scope_log_with_arguments<perfometer::log_work> scope(s_name_id);
+    scope.add(perfometer::argument::integer(s_size_id, batch.size()));
+    scope.add(perfometer::argument::integer(s_first_id, batch.front()));
+
+    std::this_thread::sleep_for(std::chrono::microseconds(10 * batch.size()));
+}
+
+int main(int argc, const char** argv)
+{
+    auto result = perfometer::initialize();
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    const perfometer::string_id flush_id = perfometer::register_string("flush");
+    const perfometer::string_id reason_id = perfometer::register_string("reason");
+    const perfometer::string_id load_id = perfometer::register_string("load");
+    const perfometer::string_id full_id = perfometer::register_string("batch full");
+    const perfometer::string_id timeout_id = perfometer::register_string("timeout");
+
+    std::vector<int> batch;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        batch.push_back(i);
+
+        if (batch.size() == 64 || i % 97 == 0)
+        {
+            process_batch(batch);
+
+            const perfometer::argument args[] =
+            {
+                perfometer::argument::string(reason_id, batch.size() == 64 ? full_id : timeout_id),
+                perfometer::argument::real(load_id, batch.size() / 64.0)
+            };
+
+            perfometer::log_event(flush_id, perfometer::get_time(), args, 2);
+
+            batch.clear();
+        }
+    }
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <queue>
+
+// Log numeric time series with PERFOMETER_LOG_COUNTER and PERFOMETER_LOG_GAUGE macros,
+// values repeating previous one are not written with skip_unchanged_counters
+
+int main(int argc, const char** argv)
+{
+    perfometer::configuration config;
+    config.skip_unchanged_counters = true;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    std::queue<int> queue;
+    size_t hits = 0;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        if (i % 3)
+        {
+            queue.push(i);
+        }
+        else if (!queue.empty() && i % 2)
+        {
+            queue.pop();
+        }
+
+        hits += i % 5 == 0;
+
+        PERFOMETER_LOG_COUNTER("queue depth", queue.size());
+        PERFOMETER_LOG_COUNTER("cache hits", hits);
+        PERFOMETER_LOG_GAUGE("hit ratio", double(hits) / (i + 1));
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return 0;
+}
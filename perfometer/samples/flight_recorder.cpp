@@ -0,0 +1,65 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+// Flight recorder mode, nothing is written while running, only the last pages are kept
+// in memory and saved with perfometer::dump() when something interesting happens
+
+void request(int i)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+    if (i % 1000 == 999)
+    {
+        PERFOMETER_LOG_EVENT("Slow request");
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    perfometer::configuration config;
+    config.flight_recorder_pages = 8;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        request(i);
+    }
+
+    // report contains the last 8 pages only, strings registered at the beginning included
+    result = perfometer::dump("perfometer.report");
+    std::cout << "perfometer::dump() returned " << result << std::endl;
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return 0;
+}
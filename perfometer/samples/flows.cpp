@@ -0,0 +1,119 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+
+// Follow requests handed from thread to thread with PERFOMETER_LOG_FLOW_* macros,
+// reader links records of the same flow id, so request latency spans thread lanes
+
+struct stage
+{
+    void push(uint64_t request)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push(request);
+        ready.notify_one();
+    }
+
+    uint64_t pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this]() { return !requests.empty(); });
+
+        uint64_t request = requests.front();
+        requests.pop();
+        return request;
+    }
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::queue<uint64_t> requests;
+};
+
+constexpr int num_requests = 100;
+
+int main(int argc, const char** argv)
+{
+    auto result = perfometer::initialize();
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    stage parse;
+    stage respond;
+
+    std::thread parser([&]()
+    {
+        PERFOMETER_LOG_THREAD_NAME("PARSER");
+
+        for (int i = 0; i < num_requests; ++i)
+        {
+            uint64_t request = parse.pop();
+
+            PERFOMETER_LOG_WORK_SCOPE("parse");
+            PERFOMETER_LOG_FLOW_STEP("parsed", request);
+
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+            respond.push(request);
+        }
+    });
+
+    std::thread responder([&]()
+    {
+        PERFOMETER_LOG_THREAD_NAME("RESPONDER");
+
+        for (int i = 0; i < num_requests; ++i)
+        {
+            uint64_t request = respond.pop();
+
+            PERFOMETER_LOG_WORK_SCOPE("respond");
+
+            std::this_thread::sleep_for(std::chrono::microseconds(300));
+
+            PERFOMETER_LOG_FLOW_END("responded", request);
+        }
+    });
+
+    for (int i = 0; i < num_requests; ++i)
+    {
+        uint64_t request = perfometer::new_flow_id();
+        PERFOMETER_LOG_FLOW_BEGIN("request", request);
+
+        parse.push(request);
+
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+
+    parser.join();
+    responder.join();
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <perfometer/sink.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+
+// Serve report on Unix domain socket while running, watch it with
+// visualizer --attach /tmp/perfometer.sock
+
+void work(int depth)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1 + std::rand() % 10));
+
+    if (depth > 0)
+    {
+        work(depth - 1);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+#if !defined(_WIN32)
+    const char* path = argc > 1 ? argv[1] : "/tmp/perfometer.sock";
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 60;
+
+    perfometer::socket_sink live(path);
+    if (!live.listening())
+    {
+        std::cout << "cannot listen on " << path << std::endl;
+        return -1;
+    }
+
+    perfometer::configuration config;
+    config.report_sink = &live;
+
+    // small batches and partial pages reach visualizer within a quarter of second
+    config.write_batch_size = 16 * 1024;
+    config.page_max_age_ms = 250;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+    std::cout << "serving report on " << path << " for " << seconds << " seconds" << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("main");
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+
+    std::thread worker([end]()
+    {
+        PERFOMETER_LOG_THREAD_NAME("worker");
+
+        while (std::chrono::steady_clock::now() < end)
+        {
+            work(std::rand() % 4);
+        }
+    });
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        work(2);
+    }
+
+    worker.join();
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+#endif
+
+    return 0;
+}
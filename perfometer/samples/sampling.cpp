@@ -0,0 +1,75 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+// Limiting records of hot functions with perfometer::set_sampling() and perfometer::set_rate_limit(),
+// dropped records are counted in suppressed records of report
+// registered strings are interned, so policy set for "hot_helper" applies to the scope logged by macro
+
+int hot_helper(int i)
+{
+    PERFOMETER_LOG_WORK_SCOPE("hot_helper");
+
+    return i * i;
+}
+
+void poll()
+{
+    PERFOMETER_LOG_EVENT("Poll");
+
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+int main(int argc, const char** argv)
+{
+    auto result = perfometer::initialize();
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    // keep every 100th call of hot_helper
+    result = perfometer::set_sampling(perfometer::register_string("hot_helper"), 100);
+    std::cout << "perfometer::set_sampling() returned " << result << std::endl;
+
+    // keep up to 50 polls per second, allowing bursts of 10
+    result = perfometer::set_rate_limit(perfometer::register_string("Poll"), 50, 10);
+    std::cout << "perfometer::set_rate_limit() returned " << result << std::endl;
+
+    int sum = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        sum += hot_helper(i);
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        poll();
+    }
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return sum == 0;
+}
@@ -0,0 +1,86 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+// Run short detailed capture of network subsystem into its own report
+// while default session keeps sparse capture of the whole application
+
+void receive_packet(perfometer::session& network, int size)
+{
+    static perfometer::string_id s_name_id = perfometer::register_string("receive_packet");
+    static perfometer::string_id s_size_id = perfometer::register_string("size");
+
+    perfometer::time start_time = perfometer::get_time();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(size / 10));
+
+    const perfometer::argument arg = perfometer::argument::integer(s_size_id, size);
+    network.log_work(s_name_id, start_time, perfometer::get_time(), &arg, 1);
+}
+
+void frame()
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main(int argc, const char** argv)
+{
+    auto result = perfometer::initialize("application.report");
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    // sessions share registered strings, thread names are logged per session
+    perfometer::session network;
+    result = network.initialize("network.report");
+    std::cout << "network.initialize() returned " << result << std::endl;
+
+    std::thread receiver([&network]()
+    {
+        network.log_thread_name(perfometer::register_string("RECEIVER"));
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            receive_packet(network, 64 + i % 1400);
+        }
+    });
+
+    for (int i = 0; i < 100; ++i)
+    {
+        frame();
+    }
+
+    receiver.join();
+
+    result = network.shutdown();
+    std::cout << "network.shutdown() returned " << result << std::endl;
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <perfometer/sink.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Stream report into gzip without temporary file and keep another one in memory
+// for in-process analysis
+
+void work()
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+int main(int argc, const char** argv)
+{
+#if !defined(_WIN32)
+    FILE* gzip = popen("gzip > sinks.report.gz", "w");
+    if (!gzip)
+    {
+        std::cout << "failed to start gzip" << std::endl;
+        return -1;
+    }
+
+    perfometer::fd_sink gzip_sink(fileno(gzip));
+
+    perfometer::configuration config;
+    config.report_sink = &gzip_sink;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+#endif
+
+    perfometer::memory_sink memory;
+
+    perfometer::configuration memory_config;
+    memory_config.report_sink = &memory;
+
+    perfometer::session in_process;
+    auto session_result = in_process.initialize(memory_config);
+    std::cout << "in_process.initialize() returned " << session_result << std::endl;
+
+    const perfometer::string_id tick_id = perfometer::register_string("tick");
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        work();
+        in_process.log_event(tick_id, perfometer::get_time());
+    }
+
+    in_process.shutdown();
+    std::cout << "in-process report takes " << memory.data().size() << " bytes" << std::endl;
+
+#if !defined(_WIN32)
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    pclose(gzip);
+#endif
+
+    return 0;
+}
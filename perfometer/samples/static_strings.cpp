@@ -0,0 +1,72 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/perfometer.h>
+#include <perfometer/helpers.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+// C++17 PERFOMETER_LOG_STATIC_* macros, string ids are computed at compile time from name
+// and source location, strings are written to report header instead of being registered
+// on first call, so logging has neither static initialization guard nor registration call
+
+void sub_task()
+{
+    PERFOMETER_LOG_STATIC_WORK_FUNCTION();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+void task()
+{
+    PERFOMETER_LOG_STATIC_WORK_FUNCTION();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        sub_task();
+    }
+
+    {
+        PERFOMETER_LOG_STATIC_WAIT_SCOPE("Waiting");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    PERFOMETER_LOG_STATIC_EVENT("Task done");
+}
+
+int main(int argc, const char** argv)
+{
+    auto result = perfometer::initialize();
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    PERFOMETER_LOG_THREAD_NAME("MAIN_THREAD");
+
+    for (int i = 0; i < 5; ++i)
+    {
+        task();
+    }
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "dynamic_string_cache.h"
+#include <cstring>
+
+namespace perfometer {
+
+constexpr uint32_t dynamic_string_cache::capacity;
+constexpr uint32_t dynamic_string_cache::npos;
+
+static uint64_t content_hash(const char* string, size_t len)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash = (hash ^ static_cast<uint8_t>(string[i])) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+dynamic_string_cache::dynamic_string_cache()
+    : m_head(npos)
+    , m_tail(npos)
+    , m_size(0)
+{
+    m_slots.reserve(capacity);
+}
+
+uint32_t dynamic_string_cache::insert(const char* string, size_t len, bool& cached)
+{
+    const uint64_t hash = content_hash(string, len);
+
+    uint32_t slot = npos;
+
+    auto it = m_slots.find(hash);
+    if (it != m_slots.end())
+    {
+        slot = it->second;
+
+        entry& e = m_entries[slot];
+        cached = e.string.size() == len && std::memcmp(e.string.data(), string, len) == 0;
+
+        unlink(slot);
+    }
+    else if (m_size < capacity)
+    {
+        slot = m_size++;
+        cached = false;
+    }
+    else
+    {
+        slot = m_tail;
+        cached = false;
+
+        unlink(slot);
+        m_slots.erase(m_entries[slot].hash);
+    }
+
+    if (!cached)
+    {
+        // on hash collision slot of other string is taken over
+        entry& e = m_entries[slot];
+        e.hash = hash;
+        e.string.assign(string, len);
+
+        m_slots[hash] = slot;
+    }
+
+    push_front(slot);
+
+    return slot;
+}
+
+void dynamic_string_cache::clear()
+{
+    m_slots.clear();
+    m_head = npos;
+    m_tail = npos;
+    m_size = 0;
+}
+
+void dynamic_string_cache::unlink(uint32_t slot)
+{
+    entry& e = m_entries[slot];
+
+    if (e.prev != npos)
+    {
+        m_entries[e.prev].next = e.next;
+    }
+    else
+    {
+        m_head = e.next;
+    }
+
+    if (e.next != npos)
+    {
+        m_entries[e.next].prev = e.prev;
+    }
+    else
+    {
+        m_tail = e.prev;
+    }
+
+    e.prev = npos;
+    e.next = npos;
+}
+
+void dynamic_string_cache::push_front(uint32_t slot)
+{
+    entry& e = m_entries[slot];
+
+    e.prev = npos;
+    e.next = m_head;
+
+    if (m_head != npos)
+    {
+        m_entries[m_head].prev = slot;
+    }
+
+    m_head = slot;
+
+    if (m_tail == npos)
+    {
+        m_tail = slot;
+    }
+}
+
+} // namespace perfometer
@@ -0,0 +1,77 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <perfometer/perfometer.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace perfometer
+{
+    // least recently used dynamic strings of a thread mapped to transient ids, slot index
+    // is the id, so evicted string id is reused by the next new string
+    // reader keeps the same mapping per thread, so cache must be cleared whenever records
+    // of the thread may be read without records written earlier, new report or dropped pages
+    class dynamic_string_cache
+    {
+    public:
+        static constexpr uint32_t capacity = 256;
+
+        dynamic_string_cache();
+
+        dynamic_string_cache(const dynamic_string_cache&) = delete;
+        dynamic_string_cache& operator = (const dynamic_string_cache&) = delete;
+
+        // returns transient id of string, cached is set if string was already written with it,
+        // otherwise string takes slot of least recently used one and has to be written
+        uint32_t insert(const char* string, size_t len, bool& cached);
+
+        void clear();
+
+        // string written with transient id, kept by clear() until other string takes the slot
+        const std::string& string(uint32_t transient_id) const { return m_entries[transient_id].string; }
+
+        size_t size() const { return m_size; }
+
+    private:
+        static constexpr uint32_t npos = capacity;
+
+        struct entry
+        {
+            uint64_t    hash = 0;
+            std::string string;
+            uint32_t    prev = npos;
+            uint32_t    next = npos;
+        };
+
+        void unlink(uint32_t slot);
+        void push_front(uint32_t slot);
+
+    private:
+        entry                                   m_entries[capacity];
+        std::unordered_map<uint64_t, uint32_t>  m_slots;    // string hash to slot
+        uint32_t                                m_head;     // most recently used
+        uint32_t                                m_tail;     // least recently used
+        uint32_t                                m_size;
+    };
+
+} // namespace perfometer
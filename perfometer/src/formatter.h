@@ -44,18 +44,19 @@ namespace perfometer
 
         formatter& operator << (const char* string)
         {
-            uint8_t string_length = std::min(255, static_cast<int>(std::strlen(string)));
-            *this << string_length;
-
-            write(string, string_length);
+            write_string(string, std::strlen(string));
+            return *this;
+        }
 
+        formatter& operator << (const uint16_t value)
+        {
+            write(reinterpret_cast<const char*>(&value), sizeof(value));
             return *this;
         }
 
         formatter& operator << (const string_id& id)
         {
-            write(reinterpret_cast<const char*>(&id), sizeof(string_id));
-            return *this;
+            return write_varint(id);
         }
 
         formatter& operator << (const format::record_type type)
@@ -76,12 +77,39 @@ namespace perfometer
             return *this;
         }
 
-        void write_string(const char* string, size_t len)
+        formatter& operator << (const double value)
+        {
+            write(reinterpret_cast<const char*>(&value), sizeof(value));
+            return *this;
+        }
+
+        formatter& write_varint(uint64_t value)
         {
-            uint8_t string_length = std::min<unsigned int>(255, len);
-            *this << string_length;
+            uint8_t bytes[format::max_varint_size];
+            size_t size = 0;
 
-            write(string, string_length);
+            while (value >= 0x80)
+            {
+                bytes[size++] = static_cast<uint8_t>(value) | 0x80;
+                value >>= 7;
+            }
+
+            bytes[size++] = static_cast<uint8_t>(value);
+
+            write(bytes, size);
+            return *this;
+        }
+
+        // writes signed difference to base as zigzag varint
+        formatter& write_time_delta(time t, time base)
+        {
+            return write_varint(format::zigzag_encode(static_cast<int64_t>(t - base)));
+        }
+
+        void write_string(const char* string, size_t len)
+        {
+            write_varint(len);
+            write(string, len);
         }
 
         void write(const void* data, size_t size)
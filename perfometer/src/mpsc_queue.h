@@ -0,0 +1,107 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <atomic>
+
+namespace perfometer
+{
+    struct queue_node
+    {
+        std::atomic<queue_node*> m_next{nullptr};
+    };
+
+    // intrusive multiple producers single consumer queue (D. Vyukov's MPSC node based queue)
+    // push is wait free and never allocates, pop is called from single consumer thread only
+    template<typename Node>
+    class mpsc_queue
+    {
+    public:
+        mpsc_queue()
+            : m_head(&m_stub)
+            , m_tail(&m_stub)
+        {
+        }
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator = (const mpsc_queue&) = delete;
+
+        void push(Node* node)
+        {
+            push_node(node);
+        }
+
+        // returns nullptr if queue is empty or producer is in the middle of push
+        Node* pop()
+        {
+            queue_node* tail = m_tail;
+            queue_node* next = tail->m_next.load(std::memory_order_acquire);
+
+            if (tail == &m_stub)
+            {
+                if (next == nullptr)
+                {
+                    return nullptr;
+                }
+
+                m_tail = next;
+                tail = next;
+                next = next->m_next.load(std::memory_order_acquire);
+            }
+
+            if (next)
+            {
+                m_tail = next;
+                return static_cast<Node*>(tail);
+            }
+
+            if (tail != m_head.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+
+            push_node(&m_stub);
+
+            next = tail->m_next.load(std::memory_order_acquire);
+            if (next)
+            {
+                m_tail = next;
+                return static_cast<Node*>(tail);
+            }
+
+            return nullptr;
+        }
+
+    private:
+        void push_node(queue_node* node)
+        {
+            node->m_next.store(nullptr, std::memory_order_relaxed);
+            queue_node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+            prev->m_next.store(node, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<queue_node*>    m_head;
+        queue_node*                 m_tail;
+        queue_node                  m_stub;
+    };
+
+} // namespace perfometer
@@ -19,85 +19,432 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE. */
 
 #include <perfometer/perfometer.h>
+#include <perfometer/compression.h>
+#include "dynamic_string_cache.h"
+#include "mpsc_queue.h"
 #include "record_buffer.h"
+#include "record_filter.h"
+#include "record_pool.h"
 #include "serializer.h"
+#include "string_table.h"
 #include <string>
 #include <cstring>
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
-#include <queue>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <chrono>
+#include <functional>
+
+#if defined(PERFOMETER_FD_SERIALIZER)
+#   define PERFOMETER_CRASH_HANDLER
+#   define PERFOMETER_FORK_HANDLER
+#   include <new>
+#   include <pthread.h>
+#   include <signal.h>
+#   include <time.h>
+#   include <unistd.h>
+#endif
 
 namespace perfometer {
 
-static bool s_initialized = false;
-serializer s_serializer;
+// ownership of page in progress, thread keeps page busy while writing a record,
+// logger reclaims only idle page and thread starts new page once it sees page reclaimed
+enum page_state : uint32_t
+{
+    page_idle,
+    page_busy,
+    page_reclaimed
+};
+
+struct thread_records;
+
+// thread records reachable by crash handler without locking, threads past capacity are not covered
+constexpr size_t max_crash_threads = 1024;
+static std::atomic<thread_records*> s_crash_records[max_crash_threads];
+static bool s_crash_handler_installed = false;
+static size_t s_crash_sessions = 0; // sessions writing report on crash, guarded by s_sessions_mutex
 
-static bool s_logging_enabled = false;
+// set by crash handler, loggers stop between iterations and leave queues and report files to handler
+static std::atomic<bool> s_crashed(false);
 
-static bool s_logger_thread_running = false;
-static std::thread s_logger_thread;
+void untrack_crash_records(thread_records& records);
 
-static std::queue<std::shared_ptr<record_buffer>> s_logger_records_queue;
-static std::unordered_map<thread_id, std::shared_ptr<record_buffer>> s_records_inprogress;
-static mutex s_records_mutex;
-static thread_local std::shared_ptr<record_buffer> s_record_cache = nullptr;
+// page in progress of a thread, registered once per thread and session to be collected on shutdown
+struct thread_records
+{
+    ~thread_records()
+    {
+        untrack_crash_records(*this);
+
+        record_buffer* buffer = page.load();
+        if (buffer)
+        {
+            pool->release(buffer);
+        }
+    }
 
-void logger_thread()
+    std::atomic<record_buffer*> page{nullptr};
+    std::atomic<time> page_time{0};         // base time of page in progress
+    std::atomic<uint32_t> state{page_busy}; // page_state, kept by thread around every record
+    uint32_t generation = 0;                // session generation the page belongs to
+    thread_id owner;
+    session_state* collector = nullptr;
+    record_pool* pool = nullptr;            // page pool of the session, page is taken by shutdown
+    size_t crash_slot = max_crash_threads;  // slot in s_crash_records, max_crash_threads if not tracked
+};
+
+void track_crash_records(thread_records& records)
 {
-    while (s_logger_thread_running)
+    for (size_t slot = 0; slot < max_crash_threads; ++slot)
     {
-        std::shared_ptr<record_buffer> buffer = nullptr;
+        thread_records* expected = nullptr;
+        if (s_crash_records[slot].compare_exchange_strong(expected, &records))
         {
-            scoped_lock lock(s_records_mutex);
+            records.crash_slot = slot;
+            return;
+        }
+    }
+}
+
+void untrack_crash_records(thread_records& records)
+{
+    if (records.crash_slot < max_crash_threads)
+    {
+        s_crash_records[records.crash_slot].store(nullptr);
+        records.crash_slot = max_crash_threads;
+    }
+}
+
+// collector of a session: configuration, page pool, queue of pages handed over to logger thread,
+// logger thread and report file, default session is static so free functions reach it directly
+struct session_state
+{
+    bool initialized = false;
+    configuration config;
+    std::string file_name;      // report file name for child process report after fork()
+    size_t slot = 0;            // index in s_sessions and per thread session states, 0 - default session
+    uint32_t generation = 0;    // changes with every initialize, pages of threads from before are dropped
+    bool crash_handled = false; // pages are written to report by crash handler
+    bool logging_enabled = false;
+
+    // set in child process by fork() handler, first call into session drops state of parent process
+    std::atomic<bool> forked{false};
+    bool forked_running = false;
+    std::atomic<time> min_duration{0};
+
+    serializer output;
+
+    std::atomic<bool> logger_thread_running{false};
+    std::thread logger_thread;
+
+    mutex logger_mutex;
+    condition_variable logger_wakeup;
+    condition_variable flush_done;
+    std::atomic<bool> logger_sleeping{false};
+    std::atomic<size_t> flush_waiters{0};
+    std::atomic<bool> logger_busy{false};
+    time last_reclaim_time = 0;
+
+    record_pool pool;
+
+    // pages are written by logger thread or by shutdown after logger stopped, never concurrently
+    uint8_t compressed_page[compression::max_compressed_size(records_cache_size)];
+
+    mpsc_queue<record_buffer> queue;
+    std::atomic<size_t> pages_queued{0};
+    std::atomic<size_t> pages_written{0};
+
+    // report file rotation by logger thread, number of current segment file
+    // and time it was started at
+    std::atomic<uint32_t> segment{0};
+    time segment_start_time = 0;
+
+    // thread names are kept for flight recorder dump
+    mutex strings_mutex;
+    std::unordered_map<thread_id, string_id> thread_names;
+    static_string_node* static_strings_written = nullptr; // logger report file only
+    size_t strings_written = 0;                           // registered strings in logger report file
+
+    // flight recorder keeps last pages handed to logger instead of writing them
+    mutex ring_mutex;
+    std::deque<record_buffer*> ring;
+    time start_time = 0;
+
+    mutex records_mutex;
+    std::unordered_map<thread_id, std::shared_ptr<thread_records>> records_inprogress;
+
+    record_filter filter;
+};
+
+// registered strings are written to every report, so ids cached by earlier session
+// and flight recorder dump remain decodable
+static string_table s_string_table;
+
+// static strings registered on static initialization, newest first, constant initialized
+// so nodes of any translation unit can be pushed before dynamic initialization of this one
+static std::atomic<static_string_node*> s_static_strings(nullptr);
+static std::atomic_flag s_static_strings_lock = ATOMIC_FLAG_INIT;
+
+// initialized sessions by slot, read by crash handler without locking
+static std::atomic<session_state*> s_sessions[max_sessions];
+static mutex s_sessions_mutex;
+static std::atomic<uint32_t> s_generation(0);
+
+static session_state s_default;
+
+// per thread sampling counters and number of records suppressed since last
+// suppressed record was written, indexed by record filter slot
+struct filter_counters
+{
+    uint32_t sampled[record_filter::capacity] = {};
+    uint64_t suppressed[record_filter::capacity] = {};
+    size_t pending = 0;
+};
+
+// thread side of a session: page in progress, filter counters, dynamic strings recently
+// written by thread, repeated ones are written as transient id reference, and last counter
+// and gauge values written as raw bits for skip_unchanged_counters, cleared along with
+// dynamic string cache as reader may not have seen earlier pages
+struct thread_state
+{
+    std::shared_ptr<thread_records> records;
+    record_buffer* record_cache = nullptr;
+    std::unique_ptr<filter_counters> counters;
+    std::unique_ptr<dynamic_string_cache> dynamic_strings;
+    std::unique_ptr<std::unordered_map<string_id, uint64_t>> counter_values;
+    uint32_t segment = 0;   // report segment dynamic strings and counter values were written to
+
+    // pages started by thread and page the last dynamic string was written to, 0 once the record
+    // named by it is written, string is written again if page was given away meanwhile
+    uint64_t page_number = 0;
+    uint64_t dynamic_string_page = 0;
+    uint32_t dynamic_string_slot = 0;
+};
+
+// default session state is reached directly, state of other sessions by session slot
+static thread_local thread_state s_default_thread;
+static thread_local std::unique_ptr<thread_state> s_session_threads[max_sessions];
+
+thread_state& thread_state_of(session_state& st)
+{
+    if (st.slot == 0)
+    {
+        return s_default_thread;
+    }
+
+    std::unique_ptr<thread_state>& ts = s_session_threads[st.slot];
+    if (!ts)
+    {
+        ts.reset(new thread_state());
+    }
+
+    return *ts;
+}
+
+bool flight_recorder(const session_state& st);
+result flush_thread_cache(session_state& st, thread_state& ts);
+result flush(session_state& st);
 
-            if (!s_logger_records_queue.empty())
+// hands page in progress of exiting thread over to logger and stops tracking the thread,
+// session may be shut down or destroyed meanwhile, s_sessions_mutex keeps it alive
+void release_thread_state(thread_state& ts)
+{
+    if (ts.records)
+    {
+        scoped_lock sessions_lock(s_sessions_mutex);
+
+        // session is only dereferenced once found running
+        session_state* st = nullptr;
+        for (auto& slot : s_sessions)
+        {
+            if (slot.load() == ts.records->collector)
             {
-                buffer = s_logger_records_queue.front();
-                s_logger_records_queue.pop();
+                st = ts.records->collector;
             }
         }
 
-        if (buffer)
+        if (st)
         {
-            formatter<serializer> output(s_serializer);
-            
-            output << format::record_type::page
-                   << uint16_t(buffer->used_size());
-            
-            output.write(buffer->data(), buffer->used_size());
+            scoped_lock lock(st->records_mutex);
 
-            output << format::record_type::page_end;
+            // entry is gone if shutdown collected the page already, it is released with thread records
+            auto it = st->records_inprogress.find(get_thread_id());
+            if (it != st->records_inprogress.end() && it->second == ts.records)
+            {
+                flush_thread_cache(*st, ts);
+
+                untrack_crash_records(*it->second);
+                st->records_inprogress.erase(it);
+
+                // rotation writes the last page of exited thread to current segment, segments
+                // started later have no pages of it, flight recorder dump may still hold them
+                if (!flight_recorder(*st))
+                {
+                    scoped_lock strings_lock(st->strings_mutex);
+                    st->thread_names.erase(get_thread_id());
+                }
+            }
         }
-        else
+    }
+
+    ts.record_cache = nullptr;
+    ts.records.reset();
+}
+
+// armed after thread states are first used, so it is destroyed before them
+struct thread_exit_guard
+{
+    ~thread_exit_guard()
+    {
+        if (!armed)
         {
-            std::this_thread::yield();
+            return;
+        }
+
+        release_thread_state(s_default_thread);
+
+        for (auto& ts : s_session_threads)
+        {
+            if (ts)
+            {
+                release_thread_state(*ts);
+            }
         }
     }
+
+    bool armed = false;
+};
+
+static thread_local thread_exit_guard s_thread_exit_guard;
+
+// free page space required before record is written, enough for any record but strings
+constexpr size_t min_free_size = 256;
+
+// string record size including record type, string id and length varints
+constexpr size_t string_record_size(size_t len)
+{
+    return 1 + 2 * format::max_varint_size + len;
 }
 
-result initialize(const char file_name[], bool running)
+// page frame header bytes, formatted before page is handed to serializer in single write
+struct frame_header
 {
-    if (s_initialized)
+    void write(const char* data, size_t size)
     {
-        return result::ok;
+        std::memcpy(m_data + m_size, data, size);
+        m_size += size;
+    }
+
+    char m_data[8];
+    size_t m_size = 0;
+};
+
+void write_page(session_state& st, serializer& file, const record_buffer& buffer)
+{
+    frame_header header;
+    formatter<frame_header> output(header);
+
+    const uint8_t* data = buffer.data();
+    size_t size = buffer.used_size();
+
+    size_t compressed_size = 0;
+    if (st.config.compression)
+    {
+        compressed_size = compression::compress(buffer.data(), buffer.used_size(),
+                                                st.compressed_page, sizeof(st.compressed_page));
     }
 
-    if (file_name == nullptr)
+    if (compressed_size && compressed_size < buffer.used_size())
     {
-        return result::invalid_arguments;
+        output << format::record_type::page_compressed
+               << uint16_t(compressed_size)
+               << uint16_t(buffer.used_size());
+
+        data = st.compressed_page;
+        size = compressed_size;
+    }
+    else
+    {
+        output << format::record_type::page
+               << uint16_t(buffer.used_size());
     }
 
-    result res = s_serializer.open_file_stream(file_name);
-    if (res != result::ok)
+    const format::record_type page_end = format::record_type::page_end;
+
+    const serializer::chunk frame[] = { { header.m_data, header.m_size },
+                                        { data, size },
+                                        { &page_end, sizeof(page_end) } };
+
+    file.write(frame, 3);
+}
+
+bool flight_recorder(const session_state& st)
+{
+    return st.config.flight_recorder_pages != 0;
+}
+
+bool rotating(const session_state& st)
+{
+    return (st.config.rotate_size || st.config.rotate_interval_ms) &&
+           !flight_recorder(st) && !st.config.report_sink;
+}
+
+// keeps page in flight recorder ring, releasing the oldest page once ring is full
+void keep_page(session_state& st, record_buffer* buffer)
+{
+    scoped_lock lock(st.ring_mutex);
+
+    st.ring.push_back(buffer);
+
+    if (st.ring.size() > st.config.flight_recorder_pages)
     {
-        s_serializer.close();
-        return res;
+        st.pool.release(st.ring.front());
+        st.ring.pop_front();
+    }
+}
+
+// writes string records of static strings from first up to but not including last,
+// nodes sharing id share name, see register_static_string
+void write_static_strings(serializer& file, static_string_node* first, static_string_node* last)
+{
+    formatter<serializer> output(file);
+
+    std::unordered_set<string_id> written;
+
+    for (static_string_node* node = first; node != last; node = node->next)
+    {
+        if (written.insert(node->id).second)
+        {
+            output << format::record_type::string
+                   << node->id;
+            output.write_string(node->name, std::min(node->length, max_string_length));
+        }
     }
+}
 
-    formatter<serializer> output(s_serializer);
+// writes string records of registered strings from first on, returns number of registered strings
+size_t write_strings(serializer& file, size_t first)
+{
+    formatter<serializer> output(file);
+
+    return s_string_table.for_each([&output](string_id str_id, const std::string& string)
+    {
+        output << format::record_type::string
+               << str_id;
+        output.write_string(string.c_str(), string.size());
+    }, first);
+}
+
+void write_header(serializer& file, time start_time)
+{
+    formatter<serializer> output(file);
 
     output.write(format::header, sizeof(format::header) - 1);
     output << format::major_version
@@ -105,7 +452,6 @@ result initialize(const char file_name[], bool running)
            << format::patch_version;
 
     uint8_t time_size = sizeof(time);
-    auto start_time = get_time();
     auto clock_frequency = get_clock_frequency();
 
     output << format::record_type::clock_configuration
@@ -130,338 +476,2072 @@ result initialize(const char file_name[], bool running)
            << format::invalid_string_id
            << "String limit overflow";
 
-    s_logger_thread_running = true;
-    s_logger_thread = std::thread(logger_thread);
-
-    s_logging_enabled = running;
-
-    s_initialized = true;
+    write_static_strings(file, s_static_strings.load(std::memory_order_acquire), nullptr);
 
-    return result::ok;
+    write_strings(file, 0);
 }
 
-result shutdown()
+// strings registered and static strings of shared libraries loaded since report file was started
+// or logger wrote them last, registering thread only interns string
+void write_new_strings(session_state& st)
 {
-    if (!s_initialized)
+    static_string_node* static_strings = s_static_strings.load(std::memory_order_acquire);
+    if (static_strings != st.static_strings_written)
     {
-        return result::not_initialized;
+        write_static_strings(st.output, static_strings, st.static_strings_written);
+        st.static_strings_written = static_strings;
     }
 
-    s_logging_enabled = false;
-
+    if (s_string_table.size() != st.strings_written)
     {
-        scoped_lock lock(s_records_mutex);
-
-        for (auto pair : s_records_inprogress)
-        {
-            std::shared_ptr<record_buffer> buffer = pair.second;
-            std::shared_ptr<record_buffer> copy(new record_buffer(*buffer));
-            s_logger_records_queue.push(std::move(copy));
-        }
-
-        s_records_inprogress.clear();
-        s_record_cache.reset();
+        st.strings_written = write_strings(st.output, st.strings_written);
     }
+}
 
-    result res = flush();
-
-    s_logger_thread_running = false;
-
-    if (s_logger_thread.joinable())
+void write_thread_names(session_state& st, serializer& file)
+{
+    // copied, so report file is not written under strings lock held across fork()
+    std::unordered_map<thread_id, string_id> thread_names;
     {
-        s_logger_thread.join();
+        scoped_lock lock(st.strings_mutex);
+        thread_names = st.thread_names;
     }
 
-    s_serializer.flush();
-    s_serializer.close();
-
-    s_initialized = false;
+    formatter<serializer> output(file);
+    for (const auto& pair : thread_names)
+    {
+        output << format::record_type::thread_name
+               << pair.first
+               << pair.second;
+    }
+}
 
-    return res;
+size_t pages_pending(const session_state& st)
+{
+    return st.pages_queued - st.pages_written;
 }
 
-result pause()
+// wakes up logger thread if it sleeps, only first caller after logger went to sleep notifies
+void wake_logger(session_state& st)
 {
-    if (!s_initialized)
+    if (st.logger_sleeping.exchange(false))
     {
-        return result::not_initialized;
+        scoped_lock lock(st.logger_mutex);
+        st.logger_wakeup.notify_one();
     }
-
-    s_logging_enabled = false;
-
-    return result::ok;
 }
 
-result resume()
+// sleeps until enough pages are queued, flush or shutdown requested, or max latency passed
+void wait_for_pages(session_state& st)
 {
-    if (!s_initialized)
+    scoped_lock lock(st.logger_mutex);
+
+    st.logger_sleeping = true;
+
+    const size_t pending = pages_pending(st);
+    if (!st.logger_thread_running ||
+        pending >= st.config.logger_wakeup_pages ||
+        (pending && st.flush_waiters))
     {
-        return result::not_initialized;
+        st.logger_sleeping = false;
+        return;
     }
 
-    s_logging_enabled = true;
+    st.logger_wakeup.wait_for(lock,
+                              std::chrono::milliseconds(st.config.logger_max_latency_ms),
+                              [&st]() { return !st.logger_sleeping; });
 
-    return result::ok;
+    st.logger_sleeping = false;
 }
 
-result flush_thread_cache()
+// writes page or keeps it in flight recorder ring, releasing page to pool once written
+void process_page(session_state& st, record_buffer* buffer)
 {
-    if (!s_initialized)
+    if (flight_recorder(st))
     {
-        return result::not_initialized;
+        keep_page(st, buffer);
     }
-
-    if (s_record_cache)
+    else
     {
-        scoped_lock lock(s_records_mutex);
-        s_logger_records_queue.push(std::move(s_record_cache));
+        write_page(st, st.output, *buffer);
+        st.pool.release(buffer);
     }
-
-    s_record_cache = nullptr;
-
-    return result::ok;
 }
 
-result flush()
+size_t process_queued_pages(session_state& st)
 {
-    if (!s_initialized)
-    {
-        return result::not_initialized;
-    }
+    size_t count = 0;
 
-    bool logger_done = false;
-    while (!logger_done)
+    while (record_buffer* buffer = st.queue.pop())
     {
-        {
-            scoped_lock lock(s_records_mutex);
-            logger_done = s_logger_records_queue.empty();
-        }
+        process_page(st, buffer);
 
-        if (!logger_done)
-        {
-            std::this_thread::yield();
-        }
+        st.pages_written++;
+        count++;
     }
 
-    return s_serializer.flush();
+    return count;
 }
 
-result ensure_buffer()
+// takes partial pages older than configured age from threads idle between records,
+// pages queued before are processed first so pages of a thread keep their order
+void reclaim_idle_pages(session_state& st)
 {
-#if defined(PERFOMETER_LOG_RECORD_SWAP_OVERHEAD)
-    time start_time = get_time();
-#endif
-    if (s_record_cache && s_record_cache->free_size() < 256)
+    if (st.config.page_max_age_ms == 0)
     {
-        result res = flush_thread_cache();
-        if (res != result::ok)
-        {
-            return res;
-        }
+        return;
     }
 
-    if (s_record_cache == nullptr)
+    const time now = get_time();
+    const time max_age = get_clock_frequency() / 1000 * st.config.page_max_age_ms;
+
+    // scanning threads a few times per max age is enough to keep age bounded
+    if (now - st.last_reclaim_time < max_age / 4)
     {
-        s_record_cache = std::make_shared<record_buffer>();
-        if (!s_record_cache || !s_record_cache->data())
-        {
-            s_record_cache = nullptr;
+        return;
+    }
 
-            return result::no_memory_available;
-        }
+    st.last_reclaim_time = now;
 
-        thread_id t_id = get_thread_id();
-        formatter<record_buffer>(*s_record_cache) << t_id;
+    std::vector<record_buffer*> reclaimed;
 
-        scoped_lock lock(s_records_mutex);
-        s_records_inprogress[t_id] = s_record_cache;
+    {
+        scoped_lock lock(st.records_mutex);
+
+        for (auto& pair : st.records_inprogress)
+        {
+            thread_records& records = *pair.second;
+
+            if (!records.page.load(std::memory_order_relaxed) ||
+                now - records.page_time.load(std::memory_order_relaxed) < max_age)
+            {
+                continue;
+            }
+
+            uint32_t state = page_idle;
+            if (records.state.compare_exchange_strong(state, page_reclaimed, std::memory_order_acquire))
+            {
+                record_buffer* buffer = records.page.exchange(nullptr, std::memory_order_acquire);
+                if (buffer)
+                {
+                    reclaimed.push_back(buffer);
+                }
+            }
+        }
     }
 
-#if defined(PERFOMETER_LOG_RECORD_SWAP_OVERHEAD)
-    time end_time = get_time();
-    if (end_time - start_time > 1000)
+    if (reclaimed.empty())
     {
-        log_work(__FUNCTION__, start_time, end_time);
+        return;
     }
-#endif
 
-    return result::ok;
-}
+    process_queued_pages(st);
 
-result log_thread_name(string_id str_id, thread_id t_id)
-{
-    if (!s_initialized)
+    for (record_buffer* buffer : reclaimed)
     {
-        return result::not_initialized;
+        process_page(st, buffer);
     }
+}
 
-    if (str_id == format::invalid_string_id)
+bool rotation_due(session_state& st)
+{
+    if (!rotating(st))
     {
-        return result::invalid_arguments;
+        return false;
     }
 
-    result res = ensure_buffer();
-    if (res != result::ok)
+    if (st.config.rotate_size && st.output.size() >= st.config.rotate_size)
     {
-        return res;
+        return true;
     }
 
-    formatter<record_buffer> output(*s_record_cache);
-
-    output << format::record_type::thread_name
-           << t_id
-           << str_id;
-
-    return result::ok;
+    return st.config.rotate_interval_ms &&
+           get_time() - st.segment_start_time >= get_clock_frequency() / 1000 * st.config.rotate_interval_ms;
 }
 
-result log_thread_name(string_id str_id)
+// takes pages in progress of all threads, waiting for records being written, so pages threads
+// handed over meanwhile are queued by the time it returns; new pages are started in next segment
+void collect_pages(session_state& st, std::vector<record_buffer*>& collected)
 {
-    return log_thread_name(str_id, get_thread_id());
-}
+    std::vector<std::shared_ptr<thread_records>> threads;
 
-result log_work(string_id str_id, time start_time, time end_time)
-{
-    if (!s_logging_enabled)
     {
-        return result::not_running;
-    }
+        scoped_lock lock(st.records_mutex);
 
-    if (str_id == format::invalid_string_id)
-    {
-        return result::invalid_arguments;
+        for (const auto& pair : st.records_inprogress)
+        {
+            threads.push_back(pair.second);
+        }
     }
 
-    result res = ensure_buffer();
-    if (res != result::ok)
+    const uint32_t segment = st.segment.load();
+
+    for (const auto& records : threads)
     {
-        return res;
-    }
+        for (;;)
+        {
+            // thread hands over page before it starts the next one
+            record_buffer* buffer = records->page.load(std::memory_order_acquire);
+            if (buffer && buffer->segment() == segment)
+            {
+                break;
+            }
 
-    formatter<record_buffer> output(*s_record_cache);
+            uint32_t state = page_idle;
+            if (records->state.compare_exchange_strong(state, page_reclaimed, std::memory_order_acquire))
+            {
+                buffer = records->page.exchange(nullptr, std::memory_order_acquire);
+                if (buffer)
+                {
+                    collected.push_back(buffer);
+                }
 
-    output << format::record_type::work
-           << str_id
-           << start_time
-           << end_time
-           << get_thread_id();
+                break;
+            }
 
-    return result::ok;
+            if (state == page_reclaimed)
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    }
 }
 
-result log_wait(string_id str_id, time start_time, time end_time)
+// takes page in progress of thread once record being written meanwhile completes, thread sees
+// page reclaimed and starts new one, so it never writes into page taken from it
+record_buffer* take_page(thread_records& records)
 {
-    if (!s_logging_enabled)
+    uint32_t state = page_idle;
+    while (!records.state.compare_exchange_weak(state, page_reclaimed, std::memory_order_acquire))
     {
-        return result::not_running;
-    }
+        // page reclaimed before is taken already, thread has not started new one since
+        if (state == page_reclaimed)
+        {
+            return nullptr;
+        }
 
-    if (str_id == format::invalid_string_id)
-    {
-        return result::invalid_arguments;
+        state = page_idle;
+        std::this_thread::yield();
     }
 
-    result res = ensure_buffer();
-    if (res != result::ok)
-    {
-        return res;
-    }
+    return records.page.exchange(nullptr, std::memory_order_acquire);
+}
 
-    formatter<record_buffer> output(*s_record_cache);
+// continues report in next segment file starting with header, registered strings and thread
+// names, so segment is read on its own; pages started in previous segment may refer to its
+// dynamic strings and counter values, they are written to it before it is closed, threads
+// clear dynamic string cache and counter values in first page of the next segment
+void rotate_report(session_state& st)
+{
+    const uint32_t segment = st.segment.load(std::memory_order_relaxed) + 1;
+    const std::string file_name = st.file_name + "." + std::to_string(segment);
 
-    output << format::record_type::wait
-           << str_id
-           << start_time
-           << end_time
-           << get_thread_id();
+    st.segment.store(segment);
 
-    return result::ok;
-}
+    std::vector<record_buffer*> collected;
+    collect_pages(st, collected);
 
-result log_event(string_id str_id, time t)
-{
-    if (!s_logging_enabled)
+    std::vector<record_buffer*> next_segment;
+
+    while (record_buffer* buffer = st.queue.pop())
     {
-        return result::not_running;
+        st.pages_written++;
+
+        if (buffer->segment() == segment)
+        {
+            next_segment.push_back(buffer);
+        }
+        else
+        {
+            process_page(st, buffer);
+        }
     }
 
-    if (str_id == format::invalid_string_id)
+    for (record_buffer* buffer : collected)
     {
-        return result::invalid_arguments;
+        if (buffer->segment() == segment)
+        {
+            next_segment.push_back(buffer);
+        }
+        else
+        {
+            process_page(st, buffer);
+        }
     }
 
-    result res = ensure_buffer();
-    if (res != result::ok)
+    st.segment_start_time = get_time();
+
+    if (st.output.reopen(file_name.c_str(), st.config) == result::ok)
+    {
+        // strings registered after this point are written by logger loop
+        st.static_strings_written = s_static_strings.load(std::memory_order_acquire);
+        st.strings_written = s_string_table.size();
+        write_header(st.output, st.start_time);
+        write_thread_names(st, st.output);
+    }
+
+    for (record_buffer* buffer : next_segment)
+    {
+        process_page(st, buffer);
+    }
+}
+
+void logger_thread(session_state& st)
+{
+    while (st.logger_thread_running)
+    {
+        // pairs with crash handler setting s_crashed before reading logger_busy
+        st.logger_busy = true;
+        if (s_crashed)
+        {
+            st.logger_busy = false;
+            break;
+        }
+
+        // names go to report ahead of records using them as far as logger sees them
+        if (!flight_recorder(st))
+        {
+            write_new_strings(st);
+        }
+
+        bool idle = process_queued_pages(st) == 0;
+
+        reclaim_idle_pages(st);
+
+        if (rotation_due(st))
+        {
+            rotate_report(st);
+        }
+
+        // batches fill up under load, while idle pass partial batch to file
+        // to keep latency of data appearing in report bounded
+        if (idle && !flight_recorder(st))
+        {
+            st.output.submit();
+        }
+
+        if (st.flush_waiters)
+        {
+            scoped_lock lock(st.logger_mutex);
+            st.flush_done.notify_all();
+        }
+
+        st.logger_busy = false;
+
+        wait_for_pages(st);
+    }
+}
+
+#if defined(PERFOMETER_CRASH_HANDLER)
+
+static const int s_crash_signals[] = { SIGSEGV, SIGBUS, SIGABRT };
+static struct sigaction s_previous_actions[sizeof(s_crash_signals) / sizeof(s_crash_signals[0])];
+
+// a second from now, crash handler shares one deadline across all waits instead of waiting per thread
+timespec crash_deadline()
+{
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += 1;
+
+    return deadline;
+}
+
+// polls condition until deadline, clock_gettime and nanosleep are async-signal-safe unlike
+// condition variables, condition is still checked once when deadline has already passed
+template<typename Condition>
+bool crash_wait(Condition condition, const timespec& deadline)
+{
+    const timespec delay = { 0, 1000000 };
+
+    while (!condition())
+    {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec))
+        {
+            return false;
+        }
+
+        nanosleep(&delay, nullptr);
+    }
+
+    return true;
+}
+
+// writes page uncompressed, compression buffer may be in use by crashed logger
+void write_crash_page(session_state& st, const record_buffer& buffer)
+{
+    frame_header header;
+    formatter<frame_header> output(header);
+
+    output << format::record_type::page
+           << uint16_t(buffer.used_size());
+
+    const format::record_type page_end = format::record_type::page_end;
+
+    const serializer::chunk frame[] = { { header.m_data, header.m_size },
+                                        { buffer.data(), buffer.used_size() },
+                                        { &page_end, sizeof(page_end) } };
+
+    st.output.crash_write(frame, 3);
+}
+
+// writes queued pages and pages in progress using async-signal-safe calls only, no locks taken
+// as crashed thread may hold any of them, other threads keep running meanwhile
+void write_crash_pages()
+{
+    const thread_id self = get_thread_id();
+    const timespec deadline = crash_deadline();
+
+    // logger crashed in the middle of iteration leaves queue as is, handler still pops it
+    s_crashed = true;
+
+    session_state* writable[max_sessions] = {};
+
+    for (size_t slot = 0; slot < max_sessions; ++slot)
+    {
+        session_state* st = s_sessions[slot].load();
+        if (!st || !st->crash_handled)
+        {
+            continue;
+        }
+
+        if (st->logger_thread.get_id() != self && !crash_wait([st]() { return !st->logger_busy; }, deadline))
+        {
+            continue;
+        }
+
+        if (!st->output.begin_crash_write())
+        {
+            continue;
+        }
+
+        writable[slot] = st;
+
+        while (record_buffer* buffer = st->queue.pop())
+        {
+            write_crash_page(*st, *buffer);
+        }
+    }
+
+    for (auto& slot : s_crash_records)
+    {
+        thread_records* records = slot.load();
+        if (!records || writable[records->collector->slot] != records->collector)
+        {
+            continue;
+        }
+
+        // record of running thread completes shortly, the last record of crashed thread may never
+        auto take_page = [records]()
+        {
+            uint32_t state = page_idle;
+            return records->state.compare_exchange_strong(state, page_reclaimed) || state == page_reclaimed;
+        };
+
+        if (records->owner == self ? take_page() : crash_wait(take_page, deadline))
+        {
+            record_buffer* buffer = records->page.exchange(nullptr);
+            if (buffer)
+            {
+                write_crash_page(*records->collector, *buffer);
+            }
+        }
+    }
+
+    for (session_state* st : writable)
+    {
+        if (st)
+        {
+            st->output.end_crash_write();
+        }
+    }
+}
+
+void crash_handler(int signal_number)
+{
+    static std::atomic<bool> s_handling(false);
+
+    // other thread crashing meanwhile waits for the first one to terminate process
+    if (!s_handling.exchange(true))
+    {
+        write_crash_pages();
+    }
+    else
+    {
+        crash_wait([]() { return false; }, crash_deadline());
+    }
+
+    // previous handler or default action terminating process runs once handler returns
+    for (size_t i = 0; i < sizeof(s_crash_signals) / sizeof(s_crash_signals[0]); ++i)
+    {
+        if (s_crash_signals[i] == signal_number)
+        {
+            sigaction(signal_number, &s_previous_actions[i], nullptr);
+        }
+    }
+
+    raise(signal_number);
+}
+
+void install_crash_handler()
+{
+    struct sigaction action = {};
+    action.sa_handler = crash_handler;
+    sigemptyset(&action.sa_mask);
+
+    for (size_t i = 0; i < sizeof(s_crash_signals) / sizeof(s_crash_signals[0]); ++i)
+    {
+        sigaction(s_crash_signals[i], &action, &s_previous_actions[i]);
+    }
+
+    s_crash_handler_installed = true;
+}
+
+void uninstall_crash_handler()
+{
+    if (!s_crash_handler_installed)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(s_crash_signals) / sizeof(s_crash_signals[0]); ++i)
+    {
+        sigaction(s_crash_signals[i], &s_previous_actions[i], nullptr);
+    }
+
+    s_crash_handler_installed = false;
+}
+
+#else
+
+void install_crash_handler()
+{
+}
+
+void uninstall_crash_handler()
+{
+}
+
+#endif
+
+result initialize(session_state& st, const configuration& config);
+
+#if defined(PERFOMETER_FORK_HANDLER)
+
+// mutexes held across fork(), sessions mutex and string table first, then those of every session
+// in order they are nested elsewhere; report file mutex is not, as it is held across file writes
+static mutex* s_fork_mutexes[2 + 6 * max_sessions];
+static size_t s_fork_locked = 0;
+
+void lock_for_fork(mutex& m)
+{
+    m.lock();
+    s_fork_mutexes[s_fork_locked++] = &m;
+}
+
+void prepare_fork()
+{
+    lock_for_fork(s_sessions_mutex);
+    lock_for_fork(s_string_table.fork_mutex());
+
+    for (auto& slot : s_sessions)
+    {
+        session_state* st = slot.load();
+        if (st)
+        {
+            lock_for_fork(st->records_mutex);
+            lock_for_fork(st->strings_mutex);
+            lock_for_fork(st->ring_mutex);
+            lock_for_fork(st->filter.fork_mutex());
+            lock_for_fork(st->pool.fork_mutex());
+            lock_for_fork(st->logger_mutex);
+        }
+    }
+}
+
+void after_fork_parent()
+{
+    for (; s_fork_locked > 0; --s_fork_locked)
+    {
+        s_fork_mutexes[s_fork_locked - 1]->unlock();
+    }
+}
+
+// pages hold records of parent process which parent process writes itself, state owned by
+// other threads of parent process and its logger thread is dropped
+void drop_forked_session(session_state& st)
+{
+    // condition variables may be left locked by logger, constructed anew along with mutexes
+    new (&st.logger_wakeup) condition_variable();
+    new (&st.flush_done) condition_variable();
+
+    for (auto& pair : st.records_inprogress)
+    {
+        untrack_crash_records(*pair.second);
+
+        record_buffer* buffer = pair.second->page.exchange(nullptr);
+        if (buffer)
+        {
+            st.pool.release(buffer);
+        }
+    }
+
+    st.records_inprogress.clear();
+
+    while (record_buffer* buffer = st.queue.pop())
+    {
+        st.pool.release(buffer);
+    }
+
+    st.pages_queued = 0;
+    st.pages_written = 0;
+
+    for (record_buffer* buffer : st.ring)
+    {
+        st.pool.release(buffer);
+    }
+
+    st.ring.clear();
+    st.thread_names.clear();
+
+    st.initialized = false;
+}
+
+// first call into session in child process drops state of parent process and, with
+// fork_policy::new_report, starts report of child process, returns whether logging runs
+bool restart_forked_session(session_state& st)
+{
+    scoped_lock sessions_lock(s_sessions_mutex);
+
+    // other thread of child process restarted session meanwhile
+    if (!st.forked)
+    {
+        return st.logging_enabled;
+    }
+
+    st.forked = false;
+
+    drop_forked_session(st);
+
+    if (st.config.on_fork == fork_policy::new_report && st.config.report_sink == nullptr)
+    {
+        const std::string file_name = st.file_name + "." + std::to_string(getpid());
+
+        configuration config = st.config;
+        config.file_name = flight_recorder(st) ? nullptr : file_name.c_str();
+        config.running = st.forked_running;
+
+        initialize(st, config);
+    }
+
+    return st.logging_enabled;
+}
+
+// forked thread is the only one in child, the rest of process may have been in any state,
+// so session is only marked forked here without allocating, starting threads or opening files
+void mark_forked_session(session_state& st)
+{
+    // report file stays with parent process, which may have been writing it
+    new (&st.output.fork_mutex()) mutex();
+    st.output.abandon();
+
+    // logger thread does not exist in child, handle is dropped without joining or detaching
+    new (&st.logger_thread) std::thread();
+    st.logger_thread_running = false;
+    st.logger_sleeping = false;
+    st.logger_busy = false;
+    st.flush_waiters = 0;
+
+    st.crash_handled = false;
+    st.forked_running = st.logging_enabled;
+    st.logging_enabled = false;
+    st.forked = true;
+}
+
+void after_fork_child()
+{
+    // recursive mutex locked by parent thread cannot be unlocked in child as owner thread id differs
+    for (size_t i = 0; i < s_fork_locked; ++i)
+    {
+        new (s_fork_mutexes[i]) mutex();
+    }
+
+    s_fork_locked = 0;
+
+    uninstall_crash_handler();
+    s_crash_sessions = 0;
+
+    for (auto& slot : s_sessions)
+    {
+        session_state* st = slot.exchange(nullptr);
+        if (st)
+        {
+            mark_forked_session(*st);
+        }
+    }
+}
+
+void install_fork_handler()
+{
+    static bool s_installed = false;
+
+    if (!s_installed)
+    {
+        s_installed = pthread_atfork(prepare_fork, after_fork_parent, after_fork_child) == 0;
+    }
+}
+
+#else
+
+bool restart_forked_session(session_state& st)
+{
+    return st.logging_enabled;
+}
+
+void install_fork_handler()
+{
+}
+
+#endif
+
+// session forked along with parent process is stopped or restarted by the first call into it
+inline bool initialized(session_state& st)
+{
+    if (st.forked.load(std::memory_order_relaxed))
+    {
+        restart_forked_session(st);
+    }
+
+    return st.initialized;
+}
+
+inline bool logging_enabled(session_state& st)
+{
+    return st.logging_enabled || (st.forked.load(std::memory_order_relaxed) && restart_forked_session(st));
+}
+
+result initialize(session_state& st, const configuration& config)
+{
+    if (initialized(st))
+    {
+        return result::ok;
+    }
+
+    if ((config.file_name == nullptr && config.report_sink == nullptr && config.flight_recorder_pages == 0) ||
+        config.logger_wakeup_pages == 0)
+    {
+        return result::invalid_arguments;
+    }
+
+    scoped_lock sessions_lock(s_sessions_mutex);
+
+    size_t slot = 0;
+    if (&st != &s_default)
+    {
+        for (slot = 1; slot < max_sessions && s_sessions[slot].load(); ++slot)
+        {
+        }
+
+        if (slot == max_sessions)
+        {
+            return result::overflow;
+        }
+    }
+
+    const size_t budget_pages = config.memory_budget / sizeof(record_buffer);
+
+    // ring holding every page of budget leaves none for threads to log into
+    if (budget_pages && budget_pages <= config.flight_recorder_pages)
+    {
+        return result::invalid_arguments;
+    }
+
+    st.config = config;
+    st.config.file_name = nullptr; // not owned, valid only during initialize
+    st.file_name = config.file_name ? config.file_name : "";
+
+    result res = st.pool.reserve(budget_pages);
+    if (res != result::ok)
+    {
+        return res;
+    }
+
+    if (budget_pages)
+    {
+        // wake logger up while half of budget still free to keep producers supplied with pages
+        st.config.logger_wakeup_pages = std::max<size_t>(1, std::min(config.logger_wakeup_pages, budget_pages / 2));
+    }
+
+    st.start_time = get_time();
+    st.segment = 0;
+    st.segment_start_time = st.start_time;
+
+    if (!flight_recorder(st))
+    {
+        res = config.report_sink ? st.output.open_sink(*config.report_sink, config)
+                                 : st.output.open_file_stream(config.file_name, config);
+        if (res != result::ok)
+        {
+            st.output.close();
+            return res;
+        }
+
+        st.static_strings_written = s_static_strings.load(std::memory_order_acquire);
+        st.strings_written = s_string_table.size();
+        write_header(st.output, st.start_time);
+    }
+
+    st.slot = slot;
+    st.generation = ++s_generation;
+
+    st.crash_handled = config.crash_handler && !flight_recorder(st) && config.report_sink == nullptr;
+    if (st.crash_handled && s_crash_sessions++ == 0)
+    {
+        install_crash_handler();
+    }
+
+    install_fork_handler();
+
+    st.logger_thread_running = true;
+    st.logger_thread = std::thread(logger_thread, std::ref(st));
+
+    st.logging_enabled = config.running;
+
+    st.initialized = true;
+
+    s_sessions[slot].store(&st);
+
+    return result::ok;
+}
+
+result shutdown(session_state& st)
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    st.logging_enabled = false;
+
+    {
+        scoped_lock sessions_lock(s_sessions_mutex);
+
+        s_sessions[st.slot].store(nullptr);
+
+        if (st.crash_handled && --s_crash_sessions == 0)
+        {
+            uninstall_crash_handler();
+        }
+
+        st.crash_handled = false;
+    }
+
+    flush_thread_cache(st, thread_state_of(st));
+
+    result res = flush(st);
+
+    st.logger_thread_running = false;
+    wake_logger(st);
+
+    if (st.logger_thread.joinable())
+    {
+        st.logger_thread.join();
+    }
+
+    // strings registered after the last logger iteration
+    if (!flight_recorder(st))
+    {
+        write_new_strings(st);
+    }
+
+    // logger is stopped, collect pages of other threads still in progress, waiting for records
+    // being written, and pages pushed after the last flush, threads start new pages in next session
+    {
+        scoped_lock lock(st.records_mutex);
+
+        for (auto& pair : st.records_inprogress)
+        {
+            untrack_crash_records(*pair.second);
+
+            record_buffer* buffer = take_page(*pair.second);
+            if (buffer)
+            {
+                if (!flight_recorder(st))
+                {
+                    write_page(st, st.output, *buffer);
+                }
+
+                st.pool.release(buffer);
+            }
+        }
+
+        st.records_inprogress.clear();
+    }
+
+    while (record_buffer* buffer = st.queue.pop())
+    {
+        if (!flight_recorder(st))
+        {
+            write_page(st, st.output, *buffer);
+        }
+
+        st.pool.release(buffer);
+
+        st.pages_written++;
+    }
+
+    {
+        scoped_lock lock(st.ring_mutex);
+
+        for (record_buffer* buffer : st.ring)
+        {
+            st.pool.release(buffer);
+        }
+
+        st.ring.clear();
+    }
+
+    {
+        scoped_lock lock(st.strings_mutex);
+        st.thread_names.clear();
+    }
+
+    if (!flight_recorder(st))
+    {
+        st.output.flush();
+        st.output.close();
+    }
+
+    st.initialized = false;
+
+    return res;
+}
+
+result pause(session_state& st)
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    st.logging_enabled = false;
+
+    return result::ok;
+}
+
+result resume(session_state& st)
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    st.logging_enabled = true;
+
+    return result::ok;
+}
+
+// returns false if minimum duration, sampling or rate limit of the name drops the record,
+// records dropped by sampling or rate limit are counted as suppressed, slot is set to
+// filter slot of the name to write suppressed count along with the record
+bool filter_record(session_state& st, thread_state& ts, string_id str_id, time t, time duration, size_t& slot)
+{
+    slot = record_filter::npos;
+
+    if (st.filter.empty())
+    {
+        return true;
+    }
+
+    const size_t found = st.filter.find(str_id);
+    if (found == record_filter::npos)
+    {
+        return true;
+    }
+
+    if (duration < st.filter.min_duration(found))
+    {
+        return false;
+    }
+
+    slot = found;
+
+    if (!ts.counters)
+    {
+        ts.counters.reset(new filter_counters());
+    }
+
+    if (st.filter.accept(slot, ts.counters->sampled[slot], t))
+    {
+        return true;
+    }
+
+    if (ts.counters->suppressed[slot]++ == 0)
+    {
+        ts.counters->pending++;
+    }
+
+    return false;
+}
+
+void write_suppressed(session_state& st, thread_state& ts, size_t slot)
+{
+    uint64_t& count = ts.counters->suppressed[slot];
+    if (count == 0)
+    {
+        return;
+    }
+
+    formatter<record_buffer> output(*ts.record_cache);
+
+    output << format::record_type::suppressed
+           << st.filter.id(slot);
+
+    output.write_varint(count);
+
+    count = 0;
+    ts.counters->pending--;
+}
+
+// writes suppressed counts of thread while page has space, the rest goes to next page
+void write_pending_suppressed(session_state& st, thread_state& ts)
+{
+    constexpr size_t max_suppressed_size = 1 + 2 * format::max_varint_size;
+
+    if (!ts.counters)
+    {
+        return;
+    }
+
+    for (size_t slot = 0; slot < record_filter::capacity && ts.counters->pending; ++slot)
+    {
+        if (ts.record_cache->free_size() < max_suppressed_size)
+        {
+            break;
+        }
+
+        write_suppressed(st, ts, slot);
+    }
+}
+
+// marks page of thread busy for record being written, drops page reclaimed by logger meanwhile
+// and page of earlier session, which its shutdown collected
+inline void acquire_page(session_state& st, thread_state& ts)
+{
+    thread_records* records = ts.records.get();
+    if (!records)
+    {
+        return;
+    }
+
+    if (records->generation != st.generation)
+    {
+        ts.record_cache = nullptr;
+        ts.records.reset();
+        ts.counters.reset();
+    }
+    else if (records->state.exchange(page_busy, std::memory_order_acquire) == page_reclaimed)
+    {
+        // logger takes page right after marking it reclaimed, new page must not be stored before
+        // or logger would take that one
+        while (records->page.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        ts.record_cache = nullptr;
+    }
+}
+
+// record is written or refused, logger may reclaim page from now on
+inline void release_page(thread_state& ts)
+{
+    if (ts.records)
+    {
+        ts.records->state.store(page_idle, std::memory_order_release);
+    }
+}
+
+// hands page in progress over to logger, page is acquired by caller
+void queue_page(session_state& st, thread_state& ts)
+{
+    write_pending_suppressed(st, ts);
+
+    ts.records->page.store(nullptr, std::memory_order_release);
+
+    st.pages_queued++;
+    st.queue.push(ts.record_cache);
+
+    ts.record_cache = nullptr;
+
+    if (pages_pending(st) >= st.config.logger_wakeup_pages)
+    {
+        wake_logger(st);
+    }
+}
+
+result flush_thread_cache(session_state& st, thread_state& ts)
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    acquire_page(st, ts);
+
+    if (ts.record_cache)
+    {
+        queue_page(st, ts);
+    }
+
+    release_page(ts);
+
+    return result::ok;
+}
+
+result flush(session_state& st)
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    const size_t pages_queued = st.pages_queued;
+
+    st.flush_waiters++;
+    wake_logger(st);
+
+    {
+        scoped_lock lock(st.logger_mutex);
+        st.flush_done.wait(lock, [&st, pages_queued]() { return st.pages_written >= pages_queued; });
+    }
+
+    st.flush_waiters--;
+
+    return flight_recorder(st) ? result::ok : st.output.flush();
+}
+
+result dump(session_state& st, const char file_name[])
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    if (!flight_recorder(st) || file_name == nullptr)
+    {
+        return result::invalid_arguments;
+    }
+
+    // move pages queued so far into ring, pages other threads are filling stay out of dump
+    flush_thread_cache(st, thread_state_of(st));
+    flush(st);
+
+    serializer output;
+
+    result res = output.open_file_stream(file_name, st.config);
+    if (res != result::ok)
+    {
+        return res;
+    }
+
+    write_header(output, st.start_time);
+    write_thread_names(st, output);
+
+    {
+        scoped_lock lock(st.ring_mutex);
+
+        for (record_buffer* buffer : st.ring)
+        {
+            write_page(st, output, *buffer);
+        }
+    }
+
+    return output.close();
+}
+
+// makes sure page of thread has at least size bytes free, handing off current page if not,
+// page stays busy until release_page(), failing call releases it
+result ensure_buffer(session_state& st, thread_state& ts, size_t size = min_free_size)
+{
+#if defined(PERFOMETER_LOG_RECORD_SWAP_OVERHEAD)
+    time start_time = get_time();
+#endif
+    acquire_page(st, ts);
+
+    if (ts.record_cache && ts.record_cache->free_size() < size)
+    {
+        queue_page(st, ts);
+    }
+
+    if (ts.record_cache == nullptr)
+    {
+        ts.record_cache = st.pool.acquire();
+        if (!ts.record_cache)
+        {
+            release_page(ts);
+            return result::no_memory_available;
+        }
+
+        ts.page_number++;
+
+        thread_id t_id = get_thread_id();
+        time base_time = get_time();
+
+        formatter<record_buffer>(*ts.record_cache) << t_id
+                                                   << base_time;
+        ts.record_cache->set_last_time(base_time);
+
+        write_pending_suppressed(st, ts);
+
+        const bool first_page = !ts.records;
+
+        if (first_page)
+        {
+            scoped_lock lock(st.records_mutex);
+
+            ts.records = std::make_shared<thread_records>();
+            ts.records->generation = st.generation;
+            ts.records->owner = t_id;
+            ts.records->collector = &st;
+            ts.records->pool = &st.pool;
+            st.records_inprogress[t_id] = ts.records;
+
+            if (st.crash_handled)
+            {
+                track_crash_records(*ts.records);
+            }
+
+            s_thread_exit_guard.armed = true;
+        }
+
+        // flight recorder may drop earlier pages, so each page defines its dynamic strings
+        // and counter values, rotated report segment is read on its own, so the first page
+        // of thread in the segment does; read once thread is tracked, so report rotation
+        // either collects page or sees it started in the next segment
+        const uint32_t segment = st.segment.load();
+
+        if (flight_recorder(st) || first_page || ts.segment != segment)
+        {
+            if (ts.dynamic_strings)
+            {
+                ts.dynamic_strings->clear();
+            }
+
+            if (ts.counter_values)
+            {
+                ts.counter_values->clear();
+            }
+
+            ts.segment = segment;
+        }
+
+        ts.record_cache->set_segment(segment);
+
+        ts.records->page_time.store(base_time, std::memory_order_relaxed);
+        ts.records->page.store(ts.record_cache, std::memory_order_release);
+    }
+
+#if defined(PERFOMETER_LOG_RECORD_SWAP_OVERHEAD)
+    time end_time = get_time();
+    if (end_time - start_time > 1000)
+    {
+        log_work(__FUNCTION__, start_time, end_time);
+    }
+#endif
+
+    return result::ok;
+}
+
+// page for record named by str_id, dynamic string naming the record is written again if its
+// page was given away since, reclaimed by logger while thread was idle or handed off when full
+result ensure_record_buffer(session_state& st, thread_state& ts, string_id str_id)
+{
+    result res = ensure_buffer(st, ts);
+    if (res != result::ok || str_id != format::dynamic_string_id || !ts.dynamic_string_page)
+    {
+        return res;
+    }
+
+    if (ts.dynamic_string_page != ts.page_number)
+    {
+        // cache keeps string of slot until other string takes it, clearing cache does not
+        const std::string& string = ts.dynamic_strings->string(ts.dynamic_string_slot);
+
+        res = ensure_buffer(st, ts, string_record_size(string.size()) + min_free_size);
+        if (res != result::ok)
+        {
+            return res;
+        }
+
+        formatter<record_buffer> output(*ts.record_cache);
+
+        output << format::record_type::dynamic_string;
+        output.write_varint(ts.dynamic_string_slot);
+        output.write_string(string.c_str(), string.size());
+    }
+
+    ts.dynamic_string_page = 0;
+
+    return result::ok;
+}
+
+result log_thread_name(session_state& st, thread_state& ts, string_id str_id, thread_id t_id)
+{
+    if (!initialized(st))
+    {
+        return result::not_initialized;
+    }
+
+    if (str_id == format::invalid_string_id)
+    {
+        return result::invalid_arguments;
+    }
+
+    // name is kept before record is written, so report segment started meanwhile
+    // gets it either from kept names or from the page
+    {
+        scoped_lock lock(st.strings_mutex);
+        st.thread_names[t_id] = str_id;
+    }
+
+    result res = ensure_buffer(st, ts);
+    if (res != result::ok)
+    {
+        return res;
+    }
+
+    formatter<record_buffer> output(*ts.record_cache);
+
+    output << format::record_type::thread_name
+           << t_id
+           << str_id;
+
+    release_page(ts);
+
+    return result::ok;
+}
+
+// writes arguments record attached to the record just written, page has room for both
+// 8 bit type, 8 bit count, per argument 8 bit type, varint name and at most 10 bytes value
+constexpr size_t max_arguments_size = 2 + max_arguments * (1 + 5 + 10);
+static_assert(max_arguments_size + 64 <= min_free_size, "record with arguments should fit in page free space");
+
+void write_arguments(record_buffer& buffer, const argument* args, size_t count)
+{
+    formatter<record_buffer> output(buffer);
+
+    output << format::record_type::arguments
+           << static_cast<uint8_t>(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const argument& arg = args[i];
+
+        output << static_cast<uint8_t>(arg.type)
+               << arg.name;
+
+        switch (arg.type)
+        {
+            case argument_type::integer:
+                output.write_varint(format::zigzag_encode(arg.value.integer));
+                break;
+            case argument_type::real:
+                output << arg.value.real;
+                break;
+            case argument_type::string:
+                output << arg.value.string;
+                break;
+        }
+    }
+}
+
+// work and wait records, shared by the calls with and without arguments, arguments block is
+// written only when count is not zero
+inline result log_scope(session_state& st, thread_state& ts, format::record_type type, string_id str_id,
+                        time start_time, time end_time, const argument* args, size_t count)
+{
+    if (!logging_enabled(st))
+    {
+        return result::not_running;
+    }
+
+    if (str_id == format::invalid_string_id || count > max_arguments)
+    {
+        return result::invalid_arguments;
+    }
+
+    const time duration = end_time - start_time;
+    if (duration < st.min_duration.load(std::memory_order_relaxed))
+    {
+        return result::ok;
+    }
+
+    size_t filter_slot;
+    if (!filter_record(st, ts, str_id, end_time, duration, filter_slot))
+    {
+        return result::ok;
+    }
+
+    result res = ensure_record_buffer(st, ts, str_id);
+    if (res != result::ok)
+    {
+        return res;
+    }
+
+    if (filter_slot != record_filter::npos)
+    {
+        write_suppressed(st, ts, filter_slot);
+    }
+
+    formatter<record_buffer> output(*ts.record_cache);
+
+    output << type
+           << str_id;
+
+    output.write_time_delta(start_time, ts.record_cache->last_time())
+          .write_varint(end_time - start_time);
+
+    ts.record_cache->set_last_time(start_time);
+
+    if (count)
+    {
+        write_arguments(*ts.record_cache, args, count);
+    }
+
+    release_page(ts);
+
+    return result::ok;
+}
+
+// event record, shared by the calls with and without arguments, arguments block is written
+// only when count is not zero
+inline result log_event_record(session_state& st, thread_state& ts, string_id str_id, time t,
+                               const argument* args, size_t count)
+{
+    if (!logging_enabled(st))
+    {
+        return result::not_running;
+    }
+
+    if (str_id == format::invalid_string_id || count > max_arguments)
+    {
+        return result::invalid_arguments;
+    }
+
+    // events have no duration, minimum duration of the name does not apply
+    size_t filter_slot;
+    if (!filter_record(st, ts, str_id, t, std::numeric_limits<time>::max(), filter_slot))
+    {
+        return result::ok;
+    }
+
+    result res = ensure_record_buffer(st, ts, str_id);
+    if (res != result::ok)
+    {
+        return res;
+    }
+
+    if (filter_slot != record_filter::npos)
+    {
+        write_suppressed(st, ts, filter_slot);
+    }
+
+    formatter<record_buffer> output(*ts.record_cache);
+
+    output << format::record_type::event
+           << str_id;
+
+    output.write_time_delta(t, ts.record_cache->last_time());
+
+    ts.record_cache->set_last_time(t);
+
+    if (count)
+    {
+        write_arguments(*ts.record_cache, args, count);
+    }
+
+    release_page(ts);
+
+    return result::ok;
+}
+
+void write_value(formatter<record_buffer>& output, int64_t value)
+{
+    output.write_varint(format::zigzag_encode(value));
+}
+
+void write_value(formatter<record_buffer>& output, double value)
+{
+    output << value;
+}
+
+// writes counter or gauge record, value bits are compared to the previous value of the name
+template<typename Value>
+result log_value(session_state& st, thread_state& ts, format::record_type type, string_id str_id, time t, Value value)
+{
+    if (!logging_enabled(st))
+    {
+        return result::not_running;
+    }
+
+    if (str_id == format::invalid_string_id)
+    {
+        return result::invalid_arguments;
+    }
+
+    size_t filter_slot;
+    if (!filter_record(st, ts, str_id, t, std::numeric_limits<time>::max(), filter_slot))
+    {
+        return result::ok;
+    }
+
+    result res = ensure_record_buffer(st, ts, str_id);
+    if (res != result::ok)
+    {
+        return res;
+    }
+
+    // checked after page is ensured, new page may have cleared previous values
+    if (st.config.skip_unchanged_counters)
+    {
+        if (!ts.counter_values)
+        {
+            ts.counter_values.reset(new std::unordered_map<string_id, uint64_t>());
+        }
+
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(value));
+
+        auto inserted = ts.counter_values->emplace(str_id, bits);
+        if (!inserted.second)
+        {
+            if (inserted.first->second == bits)
+            {
+                release_page(ts);
+                return result::ok;
+            }
+
+            inserted.first->second = bits;
+        }
+    }
+
+    if (filter_slot != record_filter::npos)
+    {
+        write_suppressed(st, ts, filter_slot);
+    }
+
+    formatter<record_buffer> output(*ts.record_cache);
+
+    output << type
+           << str_id;
+
+    output.write_time_delta(t, ts.record_cache->last_time());
+
+    write_value(output, value);
+
+    ts.record_cache->set_last_time(t);
+
+    release_page(ts);
+
+    return result::ok;
+}
+
+result log_flow(session_state& st, thread_state& ts, format::record_type type, string_id str_id, time t, uint64_t flow_id)
+{
+    if (!logging_enabled(st))
+    {
+        return result::not_running;
+    }
+
+    if (str_id == format::invalid_string_id)
+    {
+        return result::invalid_arguments;
+    }
+
+    // flows link records of other threads, dropping some of them would break the chain
+    result res = ensure_record_buffer(st, ts, str_id);
+    if (res != result::ok)
     {
         return res;
     }
 
-    formatter<record_buffer> output(*s_record_cache);
+    formatter<record_buffer> output(*ts.record_cache);
+
+    output << type
+           << str_id;
+
+    output.write_time_delta(t, ts.record_cache->last_time())
+          .write_varint(flow_id);
+
+    ts.record_cache->set_last_time(t);
+
+    release_page(ts);
+
+    return result::ok;
+}
+
+result set_sampling(session_state& st, string_id str_id, uint32_t ratio)
+{
+    if (str_id == format::invalid_string_id)
+    {
+        return result::invalid_arguments;
+    }
+
+    return st.filter.set_sampling(str_id, ratio);
+}
+
+result set_rate_limit(session_state& st, string_id str_id, uint32_t rate, uint32_t burst)
+{
+    if (str_id == format::invalid_string_id)
+    {
+        return result::invalid_arguments;
+    }
+
+    return st.filter.set_rate_limit(str_id, rate, burst);
+}
 
-    output << format::record_type::event
-           << str_id
-           << t
-           << get_thread_id();
+result set_min_duration(session_state& st, time duration)
+{
+    if (duration < 0)
+    {
+        return result::invalid_arguments;
+    }
+
+    // scope_log checks global threshold of default session before calling into library
+    if (&st == &s_default)
+    {
+        min_duration_threshold().store(duration, std::memory_order_relaxed);
+    }
+
+    st.min_duration.store(duration, std::memory_order_relaxed);
 
     return result::ok;
 }
 
-string_id register_string(const char* string)
+result set_min_duration(session_state& st, string_id str_id, time duration)
 {
-    return register_string(string, std::strlen(string));
+    if (str_id == format::invalid_string_id)
+    {
+        return result::invalid_arguments;
+    }
+
+    return st.filter.set_min_duration(str_id, duration);
 }
 
-string_id register_string(const char* string, size_t len)
+string_id write_string(session_state& st, thread_state& ts, const char* string, size_t len)
 {
-    // reserved ids
-    // 0 - "UNKNOWN"
-    // 1 - dynamic string marker
-    // string_id::max - invalid id
-    static std::atomic<string_id> s_unique_id(2);
+    // record named by failed string is refused as named by invalid id
+    if (!logging_enabled(st))
+    {
+        return format::invalid_string_id;
+    }
 
-    string_id str_id = s_unique_id;
-    if (s_unique_id == format::invalid_string_id)
+    len = std::min(len, max_string_length);
+
+    // string and record named by it have to share page, reader binds them by order in page
+    if (ensure_buffer(st, ts, string_record_size(len) + min_free_size) != result::ok)
     {
         return format::invalid_string_id;
     }
 
-    s_unique_id++;
+    if (!ts.dynamic_strings)
+    {
+        ts.dynamic_strings.reset(new dynamic_string_cache());
+    }
 
-    result res = ensure_buffer();
-    if (res != result::ok)
+    bool cached = false;
+    uint32_t transient_id = ts.dynamic_strings->insert(string, len, cached);
+
+    formatter<record_buffer> output(*ts.record_cache);
+
+    if (cached)
     {
-        return res;
+        output << format::record_type::dynamic_string_ref;
+        output.write_varint(transient_id);
+    }
+    else
+    {
+        output << format::record_type::dynamic_string;
+        output.write_varint(transient_id);
+        output.write_string(string, len);
     }
 
-    formatter<record_buffer> output(*s_record_cache);
-    
-    output << format::record_type::string
-           << str_id;
-    output.write_string(string, len);
+    // space of the record named by string is reserved, page is released meanwhile, so thread
+    // idle or refused the record does not keep it from logger and crash handler
+    ts.dynamic_string_page = ts.page_number;
+    ts.dynamic_string_slot = transient_id;
+
+    release_page(ts);
 
-    return str_id;
+    return format::dynamic_string_id;
 }
 
-string_id write_string(const char* string, size_t len)
+result initialize(const char file_name[], bool running)
+{
+    configuration config;
+    config.file_name = file_name;
+    config.running = running;
+
+    return initialize(config);
+}
+
+result initialize(const configuration& config)
+{
+    return initialize(s_default, config);
+}
+
+result shutdown()
+{
+    return shutdown(s_default);
+}
+
+result pause()
+{
+    return pause(s_default);
+}
+
+result resume()
+{
+    return resume(s_default);
+}
+
+result flush_thread_cache()
+{
+    return flush_thread_cache(s_default, s_default_thread);
+}
+
+result flush()
+{
+    return flush(s_default);
+}
+
+result dump(const char file_name[])
+{
+    return dump(s_default, file_name);
+}
+
+result log_thread_name(string_id str_id, thread_id t_id)
+{
+    return log_thread_name(s_default, s_default_thread, str_id, t_id);
+}
+
+result log_thread_name(string_id str_id)
+{
+    return log_thread_name(s_default, s_default_thread, str_id, get_thread_id());
+}
+
+result log_work(string_id str_id, time start_time, time end_time)
+{
+    return log_scope(s_default, s_default_thread, format::record_type::work, str_id, start_time, end_time, nullptr, 0);
+}
+
+result log_wait(string_id str_id, time start_time, time end_time)
+{
+    return log_scope(s_default, s_default_thread, format::record_type::wait, str_id, start_time, end_time, nullptr, 0);
+}
+
+result log_work(string_id str_id, time start_time, time end_time, const argument* args, size_t count)
+{
+    return log_scope(s_default, s_default_thread, format::record_type::work, str_id, start_time, end_time, args, count);
+}
+
+result log_wait(string_id str_id, time start_time, time end_time, const argument* args, size_t count)
+{
+    return log_scope(s_default, s_default_thread, format::record_type::wait, str_id, start_time, end_time, args, count);
+}
+
+result log_event(string_id str_id, time t)
+{
+    return log_event_record(s_default, s_default_thread, str_id, t, nullptr, 0);
+}
+
+result log_event(string_id str_id, time t, const argument* args, size_t count)
+{
+    return log_event_record(s_default, s_default_thread, str_id, t, args, count);
+}
+
+result log_counter(string_id str_id, time t, int64_t value)
+{
+    return log_value(s_default, s_default_thread, format::record_type::counter, str_id, t, value);
+}
+
+result log_gauge(string_id str_id, time t, double value)
+{
+    return log_value(s_default, s_default_thread, format::record_type::gauge, str_id, t, value);
+}
+
+uint64_t new_flow_id()
+{
+    static std::atomic<uint64_t> s_flow_id(0);
+
+    return s_flow_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+result log_flow_begin(string_id str_id, time t, uint64_t flow_id)
+{
+    return log_flow(s_default, s_default_thread, format::record_type::flow_begin, str_id, t, flow_id);
+}
+
+result log_flow_step(string_id str_id, time t, uint64_t flow_id)
+{
+    return log_flow(s_default, s_default_thread, format::record_type::flow_step, str_id, t, flow_id);
+}
+
+result log_flow_end(string_id str_id, time t, uint64_t flow_id)
+{
+    return log_flow(s_default, s_default_thread, format::record_type::flow_end, str_id, t, flow_id);
+}
+
+result set_sampling(string_id str_id, uint32_t ratio)
+{
+    return set_sampling(s_default, str_id, ratio);
+}
+
+result set_rate_limit(string_id str_id, uint32_t rate, uint32_t burst)
+{
+    return set_rate_limit(s_default, str_id, rate, burst);
+}
+
+result set_min_duration(time duration)
+{
+    return set_min_duration(s_default, duration);
+}
+
+result set_min_duration(string_id str_id, time duration)
+{
+    return set_min_duration(s_default, str_id, duration);
+}
+
+// next id probed for static string whose id other name has, same for every node of the name,
+// so the same call site registered by several libraries keeps sharing id
+string_id next_static_string_id(string_id str_id)
+{
+    const string_id next = format::static_string_id_base | ((str_id + 1) * 2654435761u);
+    return next == format::invalid_string_id ? next - 1 : next;
+}
+
+// ids are 31 bit hashes of name and call site, nodes of the same call site in several
+// libraries share id, node of other name taking id of registered node moves to next one,
+// so no two names share id in report; runs on static initialization, so only constant
+// initialized state is used
+void register_static_string(static_string_node& node)
 {
-    if (!s_logging_enabled)
+    while (s_static_strings_lock.test_and_set(std::memory_order_acquire))
     {
-        return result::not_running;
+        std::this_thread::yield();
     }
 
-    result res = ensure_buffer();
-    if (res != result::ok)
+    static_string_node* head = s_static_strings.load(std::memory_order_relaxed);
+
+    for (const static_string_node* other = head; other != nullptr; )
     {
-        return res;
+        if (other->id == node.id &&
+            (other->length != node.length || std::memcmp(other->name, node.name, node.length) != 0))
+        {
+            node.id = next_static_string_id(node.id);
+            other = head;
+            continue;
+        }
+
+        other = other->next;
     }
 
-    formatter<record_buffer> output(*s_record_cache);
-    
-    output << format::record_type::string
-           << format::dynamic_string_id;
-    output.write_string(string, len);
+    node.next = head;
+    s_static_strings.store(&node, std::memory_order_release);
 
-    return format::dynamic_string_id;
+    s_static_strings_lock.clear(std::memory_order_release);
+}
+
+string_id register_string(const char* string)
+{
+    return register_string(string, std::strlen(string));
+}
+
+string_id register_string(const char* string, size_t len)
+{
+    // reserved ids
+    // 0 - "UNKNOWN"
+    // 1 - dynamic string marker
+    // format::static_string_id_base and above - static strings
+    // string_id::max - invalid id
+    len = std::min(len, max_string_length);
+
+    // logger of every session writes strings interned since it wrote them last, so string
+    // record may follow records of other threads using the id in report
+    bool inserted = false;
+    return s_string_table.intern(string, len, inserted);
+}
+
+string_id write_string(const char* string, size_t len)
+{
+    return write_string(s_default, s_default_thread, string, len);
+}
+
+session::session()
+    : m_state(new session_state())
+    , m_owned(true)
+{
+}
+
+session::session(session_state& state)
+    : m_state(&state)
+    , m_owned(false)
+{
+}
+
+session::~session()
+{
+    if (m_owned)
+    {
+        perfometer::shutdown(*m_state);
+        delete m_state;
+    }
+}
+
+session& default_session()
+{
+    static session s_default_session(s_default);
+    return s_default_session;
+}
+
+result session::initialize(const char file_name[], bool running)
+{
+    configuration config;
+    config.file_name = file_name;
+    config.running = running;
+
+    return perfometer::initialize(*m_state, config);
+}
+
+result session::initialize(const configuration& config)
+{
+    return perfometer::initialize(*m_state, config);
+}
+
+result session::shutdown()
+{
+    return perfometer::shutdown(*m_state);
+}
+
+result session::pause()
+{
+    return perfometer::pause(*m_state);
+}
+
+result session::resume()
+{
+    return perfometer::resume(*m_state);
+}
+
+result session::flush_thread_cache()
+{
+    return perfometer::flush_thread_cache(*m_state, thread_state_of(*m_state));
+}
+
+result session::flush()
+{
+    return perfometer::flush(*m_state);
+}
+
+result session::dump(const char file_name[])
+{
+    return perfometer::dump(*m_state, file_name);
+}
+
+string_id session::write_string(const char* string, size_t len)
+{
+    return perfometer::write_string(*m_state, thread_state_of(*m_state), string, len);
+}
+
+result session::log_thread_name(string_id str_id, thread_id t_id)
+{
+    return perfometer::log_thread_name(*m_state, thread_state_of(*m_state), str_id, t_id);
+}
+
+result session::log_thread_name(string_id str_id)
+{
+    return perfometer::log_thread_name(*m_state, thread_state_of(*m_state), str_id, get_thread_id());
+}
+
+result session::log_work(string_id str_id, time start_time, time end_time)
+{
+    return log_scope(*m_state, thread_state_of(*m_state), format::record_type::work, str_id, start_time, end_time, nullptr, 0);
+}
+
+result session::log_wait(string_id str_id, time start_time, time end_time)
+{
+    return log_scope(*m_state, thread_state_of(*m_state), format::record_type::wait, str_id, start_time, end_time, nullptr, 0);
+}
+
+result session::log_work(string_id str_id, time start_time, time end_time, const argument* args, size_t count)
+{
+    return log_scope(*m_state, thread_state_of(*m_state), format::record_type::work, str_id, start_time, end_time, args, count);
+}
+
+result session::log_wait(string_id str_id, time start_time, time end_time, const argument* args, size_t count)
+{
+    return log_scope(*m_state, thread_state_of(*m_state), format::record_type::wait, str_id, start_time, end_time, args, count);
+}
+
+result session::log_event(string_id str_id, time t)
+{
+    return log_event_record(*m_state, thread_state_of(*m_state), str_id, t, nullptr, 0);
+}
+
+result session::log_event(string_id str_id, time t, const argument* args, size_t count)
+{
+    return log_event_record(*m_state, thread_state_of(*m_state), str_id, t, args, count);
+}
+
+result session::log_counter(string_id str_id, time t, int64_t value)
+{
+    return log_value(*m_state, thread_state_of(*m_state), format::record_type::counter, str_id, t, value);
+}
+
+result session::log_gauge(string_id str_id, time t, double value)
+{
+    return log_value(*m_state, thread_state_of(*m_state), format::record_type::gauge, str_id, t, value);
+}
+
+result session::log_flow_begin(string_id str_id, time t, uint64_t flow_id)
+{
+    return log_flow(*m_state, thread_state_of(*m_state), format::record_type::flow_begin, str_id, t, flow_id);
+}
+
+result session::log_flow_step(string_id str_id, time t, uint64_t flow_id)
+{
+    return log_flow(*m_state, thread_state_of(*m_state), format::record_type::flow_step, str_id, t, flow_id);
+}
+
+result session::log_flow_end(string_id str_id, time t, uint64_t flow_id)
+{
+    return log_flow(*m_state, thread_state_of(*m_state), format::record_type::flow_end, str_id, t, flow_id);
+}
+
+result session::set_sampling(string_id str_id, uint32_t ratio)
+{
+    return perfometer::set_sampling(*m_state, str_id, ratio);
+}
+
+result session::set_rate_limit(string_id str_id, uint32_t rate, uint32_t burst)
+{
+    return perfometer::set_rate_limit(*m_state, str_id, rate, burst);
+}
+
+result session::set_min_duration(time duration)
+{
+    return perfometer::set_min_duration(*m_state, duration);
+}
+
+result session::set_min_duration(string_id str_id, time duration)
+{
+    return perfometer::set_min_duration(*m_state, str_id, duration);
 }
 
-} // namespace perfometer
\ No newline at end of file
+} // namespace perfometer
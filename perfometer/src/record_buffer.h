@@ -24,10 +24,13 @@ SOFTWARE. */
 #include <perfometer/format.h>
 
 #include "formatter.h"
+#include "mpsc_queue.h"
+
+#include <atomic>
 
 namespace perfometer
 {
-    class record_buffer
+    class record_buffer : public queue_node
     {
     public:
         record_buffer()
@@ -36,7 +39,10 @@ namespace perfometer
         }
 
         explicit record_buffer(const record_buffer& copy)
-            : m_curr_pos(m_data + copy.used_size())
+            : queue_node()
+            , m_curr_pos(m_data + copy.used_size())
+            , m_last_time(copy.m_last_time)
+            , m_segment(copy.m_segment)
         {
             memcpy(m_data, copy.m_data, copy.used_size());
         }
@@ -58,6 +64,21 @@ namespace perfometer
 
         const uint8_t* data() const { return m_data; }
 
+        void reset()
+        {
+            m_curr_pos = m_data;
+            m_last_time = 0;
+            m_segment = 0;
+        }
+
+        // previous record time in page, records store time as delta to it
+        time last_time() const { return m_last_time; }
+        void set_last_time(time t) { m_last_time = t; }
+
+        // report segment page was started in, its records refer to strings written to that segment
+        uint32_t segment() const { return m_segment; }
+        void set_segment(uint32_t segment) { m_segment = segment; }
+
         void write(const void *data, size_t size)
         {
             if (data && size <= free_size())
@@ -68,8 +89,15 @@ namespace perfometer
         }
 
     private:
+        friend class record_pool;
+
         uint8_t     m_data[records_cache_size];
         uint8_t*    m_curr_pos;
+        time        m_last_time = 0;
+        uint32_t    m_segment = 0;
+
+        uint32_t                m_pool_index = 0;
+        std::atomic<uint32_t>   m_pool_next{0};
     };
 
 } // namespace perfometer
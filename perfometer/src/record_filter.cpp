@@ -0,0 +1,196 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "record_filter.h"
+#include <algorithm>
+
+namespace perfometer {
+
+constexpr size_t record_filter::capacity;
+constexpr size_t record_filter::npos;
+
+static size_t slot_hash(string_id str_id)
+{
+    return (static_cast<uint32_t>(str_id) * 2654435761u) % record_filter::capacity;
+}
+
+record_filter::record_filter()
+    : m_size(0)
+{
+}
+
+result record_filter::set_sampling(string_id str_id, uint32_t ratio)
+{
+    if (ratio == 0)
+    {
+        return result::invalid_arguments;
+    }
+
+    scoped_lock lock(m_mutex);
+
+    entry* e = insert(str_id);
+    if (!e)
+    {
+        return result::overflow;
+    }
+
+    e->ratio.store(ratio, std::memory_order_relaxed);
+
+    return result::ok;
+}
+
+result record_filter::set_rate_limit(string_id str_id, uint32_t rate, uint32_t burst)
+{
+    scoped_lock lock(m_mutex);
+
+    entry* e = insert(str_id);
+    if (!e)
+    {
+        return result::overflow;
+    }
+
+    const time interval = rate ? std::max<time>(1, get_clock_frequency() / rate) : 0;
+
+    e->tolerance.store(interval * (burst ? burst - 1 : 0), std::memory_order_relaxed);
+    e->interval.store(interval, std::memory_order_relaxed);
+
+    return result::ok;
+}
+
+result record_filter::set_min_duration(string_id str_id, time duration)
+{
+    if (duration < 0)
+    {
+        return result::invalid_arguments;
+    }
+
+    scoped_lock lock(m_mutex);
+
+    entry* e = insert(str_id);
+    if (!e)
+    {
+        return result::overflow;
+    }
+
+    e->min_duration.store(duration, std::memory_order_relaxed);
+
+    return result::ok;
+}
+
+size_t record_filter::find(string_id str_id) const
+{
+    const uint32_t key = static_cast<uint32_t>(str_id) + 1;
+
+    size_t slot = slot_hash(str_id);
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        const uint32_t slot_key = m_entries[slot].key.load(std::memory_order_acquire);
+        if (slot_key == key)
+        {
+            return slot;
+        }
+
+        if (slot_key == 0)
+        {
+            break;
+        }
+
+        slot = (slot + 1) % capacity;
+    }
+
+    return npos;
+}
+
+bool record_filter::accept(size_t slot, uint32_t& sample_counter, time t)
+{
+    entry& e = m_entries[slot];
+
+    const uint32_t ratio = e.ratio.load(std::memory_order_relaxed);
+    if (ratio > 1)
+    {
+        const bool sampled = sample_counter == 0;
+
+        if (++sample_counter >= ratio)
+        {
+            sample_counter = 0;
+        }
+
+        if (!sampled)
+        {
+            return false;
+        }
+    }
+
+    const time interval = e.interval.load(std::memory_order_relaxed);
+    if (interval == 0)
+    {
+        return true;
+    }
+
+    // generic cell rate algorithm, token bucket expressed as single arrival time
+    const time tolerance = e.tolerance.load(std::memory_order_relaxed);
+
+    time arrival_time = e.arrival_time.load(std::memory_order_relaxed);
+    time next_arrival_time;
+
+    do
+    {
+        if (t < arrival_time - tolerance)
+        {
+            return false;
+        }
+
+        next_arrival_time = std::max(arrival_time, t) + interval;
+    }
+    while (!e.arrival_time.compare_exchange_weak(arrival_time, next_arrival_time, std::memory_order_relaxed));
+
+    return true;
+}
+
+record_filter::entry* record_filter::insert(string_id str_id)
+{
+    const size_t found = find(str_id);
+    if (found != npos)
+    {
+        return &m_entries[found];
+    }
+
+    const uint32_t key = static_cast<uint32_t>(str_id) + 1;
+
+    size_t slot = slot_hash(str_id);
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        entry& e = m_entries[slot];
+
+        if (e.key.load(std::memory_order_relaxed) == 0)
+        {
+            e.key.store(key, std::memory_order_release);
+            m_size++;
+
+            return &e;
+        }
+
+        slot = (slot + 1) % capacity;
+    }
+
+    return nullptr;
+}
+
+} // namespace perfometer
@@ -0,0 +1,81 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <perfometer/perfometer.h>
+
+#include <atomic>
+
+namespace perfometer
+{
+    // per string id collection policies checked before record reaches page: minimum duration,
+    // 1 in N sampling, counted per thread, and token bucket rate limit shared by all threads
+    // entries are only added, set duration 0, ratio 1 and rate 0 to turn policy off
+    class record_filter
+    {
+    public:
+        static constexpr size_t capacity = 256;
+        static constexpr size_t npos = capacity;
+
+        record_filter();
+
+        record_filter(const record_filter&) = delete;
+        record_filter& operator = (const record_filter&) = delete;
+
+        result set_sampling(string_id str_id, uint32_t ratio);
+        result set_rate_limit(string_id str_id, uint32_t rate, uint32_t burst);
+        result set_min_duration(string_id str_id, time duration);
+
+        bool empty() const { return m_size.load(std::memory_order_relaxed) == 0; }
+
+        // returns slot of string id policy or npos
+        size_t find(string_id str_id) const;
+
+        string_id id(size_t slot) const { return static_cast<string_id>(m_entries[slot].key.load(std::memory_order_acquire) - 1); }
+
+        time min_duration(size_t slot) const { return m_entries[slot].min_duration.load(std::memory_order_relaxed); }
+
+        // sample_counter is calling thread counter of the slot, t is record time
+        bool accept(size_t slot, uint32_t& sample_counter, time t);
+
+        // held across fork() so child process inherits filter in consistent state
+        mutex& fork_mutex() { return m_mutex; }
+
+    private:
+        struct entry
+        {
+            std::atomic<uint32_t>   key{0};             // string id + 1, 0 - empty slot
+            std::atomic<time>       min_duration{0};
+            std::atomic<uint32_t>   ratio{1};
+            std::atomic<time>       interval{0};        // ticks between records, 0 - no rate limit
+            std::atomic<time>       tolerance{0};       // burst allowance in ticks
+            std::atomic<time>       arrival_time{0};    // theoretical arrival time of next record
+        };
+
+        entry* insert(string_id str_id); // m_mutex must be held
+
+    private:
+        entry                   m_entries[capacity];
+        std::atomic<size_t>     m_size;
+        mutex                   m_mutex;
+    };
+
+} // namespace perfometer
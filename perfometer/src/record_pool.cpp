@@ -0,0 +1,178 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "record_pool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace perfometer {
+
+constexpr size_t record_pool::chunk_size;
+constexpr size_t record_pool::max_chunks;
+
+constexpr uint64_t tag_increment = uint64_t(1) << 32;
+constexpr uint64_t index_mask = tag_increment - 1;
+
+record_pool::record_pool()
+    : m_free_head(0)
+    , m_allocated(0)
+    , m_max_pages(0)
+    , m_num_chunks(0)
+{
+}
+
+record_pool::~record_pool()
+{
+    for (size_t i = 0; i < m_num_chunks; ++i)
+    {
+        delete[] m_chunks[i];
+    }
+}
+
+result record_pool::reserve(size_t max_pages)
+{
+    scoped_lock lock(m_grow_mutex);
+
+    m_max_pages = max_pages;
+
+    while (m_allocated < max_pages)
+    {
+        if (!allocate_chunk())
+        {
+            return result::no_memory_available;
+        }
+    }
+
+    return result::ok;
+}
+
+record_buffer* record_pool::acquire()
+{
+    uint64_t head = m_free_head.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        uint32_t index = static_cast<uint32_t>(head & index_mask);
+        if (index == 0)
+        {
+            if (!grow())
+            {
+                return nullptr;
+            }
+
+            head = m_free_head.load(std::memory_order_acquire);
+            continue;
+        }
+
+        record_buffer* buffer = page(index - 1);
+        uint64_t next = ((head & ~index_mask) + tag_increment) |
+                        buffer->m_pool_next.load(std::memory_order_relaxed);
+
+        if (m_free_head.compare_exchange_weak(head, next,
+                                              std::memory_order_acquire,
+                                              std::memory_order_acquire))
+        {
+            buffer->reset();
+            return buffer;
+        }
+    }
+}
+
+void record_pool::release(record_buffer* buffer)
+{
+    uint64_t head = m_free_head.load(std::memory_order_relaxed);
+    uint64_t next = 0;
+
+    do
+    {
+        buffer->m_pool_next.store(static_cast<uint32_t>(head & index_mask), std::memory_order_relaxed);
+        next = ((head & ~index_mask) + tag_increment) | (buffer->m_pool_index + 1);
+    }
+    while (!m_free_head.compare_exchange_weak(head, next,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+}
+
+bool record_pool::grow()
+{
+    const size_t max_pages = m_max_pages;
+    if (max_pages && m_allocated >= max_pages)
+    {
+        return false;
+    }
+
+    scoped_lock lock(m_grow_mutex);
+
+    if (m_free_head.load(std::memory_order_acquire) & index_mask)
+    {
+        // another thread refilled pool meanwhile
+        return true;
+    }
+
+    return allocate_chunk();
+}
+
+bool record_pool::allocate_chunk()
+{
+    const size_t max_pages = m_max_pages;
+
+    size_t count = chunk_size;
+    if (max_pages)
+    {
+        if (m_allocated >= max_pages)
+        {
+            return false;
+        }
+
+        count = std::min(count, max_pages - m_allocated);
+    }
+
+    if (m_num_chunks == max_chunks)
+    {
+        return false;
+    }
+
+    record_buffer* pages = new (std::nothrow) record_buffer[count];
+    if (!pages)
+    {
+        return false;
+    }
+
+    const size_t chunk = m_num_chunks;
+    m_chunks[chunk] = pages;
+    m_num_chunks++;
+    m_allocated += count;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        pages[i].m_pool_index = static_cast<uint32_t>(chunk * chunk_size + i);
+        release(&pages[i]);
+    }
+
+    return true;
+}
+
+record_buffer* record_pool::page(uint32_t index) const
+{
+    return &m_chunks[index / chunk_size][index % chunk_size];
+}
+
+} // namespace perfometer
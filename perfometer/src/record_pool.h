@@ -0,0 +1,73 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <perfometer/perfometer.h>
+#include "record_buffer.h"
+
+#include <atomic>
+
+namespace perfometer
+{
+    // pool of record pages recycled between producer threads and logger thread
+    // pages are allocated in chunks and kept until pool destruction, so once warmed up
+    // or reserved logging does not touch heap, acquire and release are lock free
+    class record_pool
+    {
+    public:
+        static constexpr size_t chunk_size = 64;
+        static constexpr size_t max_chunks = 16384;
+
+        record_pool();
+        ~record_pool();
+
+        record_pool(const record_pool&) = delete;
+        record_pool& operator = (const record_pool&) = delete;
+
+        // limits pool to max_pages pages and preallocates them, 0 - no limit, allocate on demand
+        result reserve(size_t max_pages);
+
+        // returns empty page or nullptr if page limit reached or allocation failed
+        record_buffer* acquire();
+        void release(record_buffer* buffer);
+
+        size_t allocated() const { return m_allocated; }
+
+        // held across fork() so child process inherits pool in consistent state
+        mutex& fork_mutex() { return m_grow_mutex; }
+
+    private:
+        bool grow();
+        bool allocate_chunk(); // m_grow_mutex must be held
+        record_buffer* page(uint32_t index) const;
+
+    private:
+        // free list head, low 32 bits - page index + 1 (0 - empty), high 32 bits - ABA tag
+        std::atomic<uint64_t>   m_free_head;
+        std::atomic<size_t>     m_allocated;
+        std::atomic<size_t>     m_max_pages;
+
+        size_t                  m_num_chunks;
+        record_buffer*          m_chunks[max_chunks];
+        mutex                   m_grow_mutex;
+    };
+
+} // namespace perfometer
@@ -20,6 +20,18 @@ SOFTWARE. */
 
 #include "serializer.h"
 
+#include <algorithm>
+
+#if defined(PERFOMETER_FD_SERIALIZER)
+#   include <cerrno>
+#   include <cstdlib>
+#   include <cstring>
+#   include <fcntl.h>
+#   include <sys/uio.h>
+#   include <time.h>
+#   include <unistd.h>
+#endif
+
 namespace perfometer {
 
 serializer::serializer()
@@ -31,10 +43,526 @@ serializer::~serializer()
     close();
 }
 
-result serializer::open_file_stream(const char file_name[])
+result serializer::open_sink(sink& output, const configuration& config)
+{
+    scoped_lock lock(s_file_mutex);
+
+    // batch holds at least a couple of pages, so sink is not called for every page
+    m_batch_capacity = std::max(config.write_batch_size, 2 * records_cache_size);
+    m_batch.reserve(m_batch_capacity);
+
+    m_sink = &output;
+    m_sink_status = result::ok;
+
+    return m_sink_status;
+}
+
+// appends chunks to batch, batch is handed to sink once next chunks do not fit,
+// so sink always receives whole frames
+result serializer::write_to_sink(const chunk* chunks, size_t count)
+{
+    size_t total_size = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total_size += chunks[i].size;
+    }
+
+    if (m_batch.size() + total_size > m_batch_capacity)
+    {
+        submit_to_sink();
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(chunks[i].data);
+        m_batch.insert(m_batch.end(), data, data + chunks[i].size);
+    }
+
+    return m_sink_status;
+}
+
+result serializer::submit_to_sink()
+{
+    if (m_batch.empty() || m_sink_status != result::ok)
+    {
+        return m_sink_status;
+    }
+
+    m_sink_status = m_sink->write(m_batch.data(), m_batch.size());
+    m_batch.clear();
+
+    return m_sink_status;
+}
+
+result serializer::close_sink()
+{
+    submit_to_sink();
+
+    result res = m_sink->close();
+    if (m_sink_status == result::ok)
+    {
+        m_sink_status = res;
+    }
+
+    m_sink = nullptr;
+    std::vector<uint8_t>().swap(m_batch);
+
+    return m_sink_status;
+}
+
+#if defined(PERFOMETER_FD_SERIALIZER)
+
+// O_DIRECT requires buffer address, file offset and write size aligned to logical block size
+constexpr size_t direct_io_alignment = 4096;
+
+// crash handler waits this long for another thread to finish writing file
+constexpr int crash_wait_ms = 1000;
+
+serializer::write_scope::write_scope(serializer& file)
+    : m_file(file)
+{
+    // pairs with crash handler setting m_crashed before reading m_writer
+    m_file.m_writer.store(get_thread_id());
+    m_allowed = !m_file.m_crashed.load();
+}
+
+serializer::write_scope::~write_scope()
+{
+    m_file.m_writer.store(thread_id());
+}
+
+result serializer::open_file_stream(const char file_name[], const configuration& config)
+{
+    scoped_lock lock(s_file_mutex);
+
+    return open_file(file_name, config);
+}
+
+result serializer::open_file(const char file_name[], const configuration& config)
+{
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    m_direct_io = false;
+    m_fd = -1;
+
+    if (config.direct_io)
+    {
+        m_fd = ::open(file_name, flags | O_DIRECT, 0644);
+        m_direct_io = m_fd >= 0;
+    }
+
+    if (m_fd < 0)
+    {
+        // file system may not support O_DIRECT, tmpfs for example
+        m_fd = ::open(file_name, flags, 0644);
+    }
+
+    if (m_fd < 0)
+    {
+        return m_status = result::io_error;
+    }
+
+    const size_t batch_size = std::max(config.write_batch_size, direct_io_alignment);
+    m_capacity = (batch_size + direct_io_alignment - 1) / direct_io_alignment * direct_io_alignment;
+
+    release_buffer();
+
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, direct_io_alignment, m_capacity) != 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        return m_status = result::no_memory_available;
+    }
+
+    m_buffer = static_cast<uint8_t*>(buffer);
+    m_size = 0;
+    m_offset = 0;
+    m_sync = config.sync;
+
+    return m_status = result::ok;
+}
+
+result serializer::flush()
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        submit_to_sink();
+        return m_sink_status == result::ok ? m_sink->flush() : m_sink_status;
+    }
+
+    write_scope scope(*this);
+    if (!scope.allowed())
+    {
+        return result::io_error;
+    }
+
+    return write_staged(m_sync != file_sync::none);
+}
+
+result serializer::submit()
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return submit_to_sink();
+    }
+
+    write_scope scope(*this);
+    if (!scope.allowed())
+    {
+        return result::io_error;
+    }
+
+    return write_staged(m_sync == file_sync::every_write);
+}
+
+result serializer::close()
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return close_sink();
+    }
+
+    return close_file();
+}
+
+result serializer::reopen(const char file_name[], const configuration& config)
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return result::invalid_arguments;
+    }
+
+    result res = close_file();
+    result open_res = open_file(file_name, config);
+
+    return res == result::ok ? open_res : res;
+}
+
+size_t serializer::size()
+{
+    scoped_lock lock(s_file_mutex);
+
+    return m_sink || m_fd < 0 ? 0 : static_cast<size_t>(m_offset) + m_size;
+}
+
+result serializer::close_file()
+{
+    write_scope scope(*this);
+    if (!scope.allowed())
+    {
+        return result::io_error;
+    }
+
+    if (m_fd < 0)
+    {
+        // staging buffer abandoned in child process after fork()
+        release_buffer();
+        return m_status;
+    }
+
+    write_staged(m_sync != file_sync::none);
+
+    // direct writes are padded up to alignment, cut padding of the last block
+    if (m_direct_io && ftruncate(m_fd, m_offset + m_size) != 0)
+    {
+        m_status = result::io_error;
+    }
+
+    if (::close(m_fd) != 0)
+    {
+        m_status = result::io_error;
+    }
+
+    m_fd = -1;
+    m_size = 0;
+
+    release_buffer();
+
+    return m_status;
+}
+
+result serializer::status()
+{
+    scoped_lock lock(s_file_mutex);
+
+    return m_sink ? m_sink_status : m_status;
+}
+
+result serializer::write(const char* data, size_t size)
+{
+    chunk data_chunk = { data, size };
+    return write(&data_chunk, 1);
+}
+
+result serializer::write(const chunk* chunks, size_t count)
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return write_to_sink(chunks, count);
+    }
+
+    write_scope scope(*this);
+    if (!scope.allowed() || m_fd < 0)
+    {
+        return result::io_error;
+    }
+
+    size_t total_size = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total_size += chunks[i].size;
+    }
+
+    if (!m_direct_io && m_size + total_size > m_capacity && count < max_chunks)
+    {
+        // staged data and chunks go to file with single pwritev without copying chunks
+        chunk all[max_chunks] = { { m_buffer, m_size } };
+        std::copy(chunks, chunks + count, all + 1);
+
+        m_size = 0;
+
+        if (write_all(all, count + 1) == result::ok && m_sync == file_sync::every_write &&
+            fdatasync(m_fd) != 0)
+        {
+            m_status = result::io_error;
+        }
+
+        return m_status;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(chunks[i].data);
+        size_t size = chunks[i].size;
+
+        while (size)
+        {
+            const size_t part = std::min(size, m_capacity - m_size);
+            std::memcpy(m_buffer + m_size, data, part);
+
+            m_size += part;
+            data += part;
+            size -= part;
+
+            if (m_size == m_capacity)
+            {
+                write_staged(m_sync == file_sync::every_write);
+            }
+        }
+    }
+
+    return m_status;
+}
+
+void serializer::release_buffer()
+{
+    std::free(m_buffer);
+    m_buffer = nullptr;
+}
+
+void serializer::abandon()
+{
+    // sink stays with parent process
+    m_sink = nullptr;
+    m_batch.clear();
+    m_sink_status = result::ok;
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+
+    // runs in fork() handler, staging buffer is freed by next open or close
+    m_fd = -1;
+    m_size = 0;
+    m_status = result::ok;
+    m_crashed = false;
+    m_writer = thread_id();
+}
+
+bool serializer::begin_crash_write()
+{
+    // sink is not async-signal-safe
+    if (m_sink)
+    {
+        return false;
+    }
+
+    // pairs with write_scope setting m_writer before reading m_crashed
+    m_crashed.store(true);
+
+    const thread_id self = get_thread_id();
+    const timespec delay = { 0, 1000000 };
+
+    for (int waited_ms = 0; m_writer.load() != thread_id(); ++waited_ms)
+    {
+        if (m_writer.load() == self || waited_ms == crash_wait_ms)
+        {
+            return false;
+        }
+
+        nanosleep(&delay, nullptr);
+    }
+
+    if (m_fd < 0 || m_status != result::ok)
+    {
+        return false;
+    }
+
+    // frames are written unpadded, earlier padding is cut by end_crash_write()
+    if (m_direct_io)
+    {
+        const int flags = fcntl(m_fd, F_GETFL);
+        if (flags == -1 || fcntl(m_fd, F_SETFL, flags & ~O_DIRECT) == -1)
+        {
+            return false;
+        }
+
+        m_direct_io = false;
+    }
+
+    chunk staged = { m_buffer, m_size };
+    m_size = 0;
+
+    return write_all(&staged, 1) == result::ok;
+}
+
+result serializer::crash_write(const chunk* chunks, size_t count)
+{
+    return write_all(chunks, count);
+}
+
+result serializer::end_crash_write()
+{
+    if (ftruncate(m_fd, m_offset) != 0 ||
+        (m_sync != file_sync::none && fdatasync(m_fd) != 0))
+    {
+        m_status = result::io_error;
+    }
+
+    return m_status;
+}
+
+// writes staged data, in direct mode last partial block is written padded
+// and kept staged to be written again at the same offset once complete
+result serializer::write_staged(bool sync)
+{
+    if (m_fd < 0 || m_status != result::ok)
+    {
+        return m_status;
+    }
+
+    if (m_size)
+    {
+        size_t write_size = m_size;
+        size_t complete_size = m_size;
+
+        if (m_direct_io)
+        {
+            write_size = (m_size + direct_io_alignment - 1) / direct_io_alignment * direct_io_alignment;
+            complete_size = m_size / direct_io_alignment * direct_io_alignment;
+
+            std::memset(m_buffer + m_size, 0, write_size - m_size);
+        }
+
+        const size_t partial_size = m_size - complete_size;
+        chunk staged = { m_buffer, write_size };
+
+        if (write_all(&staged, 1) != result::ok)
+        {
+            return m_status;
+        }
+
+        m_offset -= write_size - complete_size;
+
+        if (partial_size && complete_size)
+        {
+            std::memmove(m_buffer, m_buffer + complete_size, partial_size);
+        }
+
+        m_size = partial_size;
+    }
+
+    if (sync && fdatasync(m_fd) != 0)
+    {
+        m_status = result::io_error;
+    }
+
+    return m_status;
+}
+
+// writes chunks at current offset with as few pwritev calls as possible
+result serializer::write_all(const chunk* chunks, size_t count)
+{
+    iovec iov[max_chunks];
+    size_t iov_count = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (chunks[i].size)
+        {
+            iov[iov_count].iov_base = const_cast<void*>(chunks[i].data);
+            iov[iov_count].iov_len = chunks[i].size;
+            iov_count++;
+        }
+    }
+
+    size_t index = 0;
+    while (index < iov_count)
+    {
+        ssize_t written = pwritev(m_fd, iov + index, static_cast<int>(iov_count - index), m_offset);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return m_status = result::io_error;
+        }
+
+        m_offset += written;
+
+        size_t remaining = static_cast<size_t>(written);
+        while (index < iov_count && remaining >= iov[index].iov_len)
+        {
+            remaining -= iov[index].iov_len;
+            index++;
+        }
+
+        if (index < iov_count)
+        {
+            iov[index].iov_base = static_cast<uint8_t*>(iov[index].iov_base) + remaining;
+            iov[index].iov_len -= remaining;
+        }
+    }
+
+    return m_status;
+}
+
+#else
+
+result serializer::open_file_stream(const char file_name[], const configuration& config)
 {
     scoped_lock lock(s_file_mutex);
 
+    return open_file(file_name, config);
+}
+
+result serializer::open_file(const char file_name[], const configuration& config)
+{
+    m_report_file.clear();
     m_report_file.open(file_name, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc);
 
     if (!m_report_file)
@@ -49,27 +577,130 @@ result serializer::flush()
 {
     scoped_lock lock(s_file_mutex);
 
+    if (m_sink)
+    {
+        submit_to_sink();
+        return m_sink_status == result::ok ? m_sink->flush() : m_sink_status;
+    }
+
     m_report_file.flush();
 
     return status();
 }
 
+result serializer::submit()
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return submit_to_sink();
+    }
+
+    return status();
+}
+
 result serializer::close()
 {
     scoped_lock lock(s_file_mutex);
 
+    if (m_sink)
+    {
+        return close_sink();
+    }
+
+    return close_file();
+}
+
+result serializer::close_file()
+{
     m_report_file.close();
 
     return status();
 }
 
+result serializer::reopen(const char file_name[], const configuration& config)
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return result::invalid_arguments;
+    }
+
+    result res = close_file();
+    result open_res = open_file(file_name, config);
+
+    return res == result::ok ? open_res : res;
+}
+
+size_t serializer::size()
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink || !m_report_file.is_open())
+    {
+        return 0;
+    }
+
+    const std::streampos position = m_report_file.tellp();
+    return position < 0 ? 0 : static_cast<size_t>(position);
+}
+
+result serializer::status()
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return m_sink_status;
+    }
+
+    return m_report_file.fail() ? result::io_error : result::ok;
+}
+
+void serializer::abandon()
+{
+    // sink stays with parent process
+    m_sink = nullptr;
+    m_batch.clear();
+    m_sink_status = result::ok;
+
+    // std::ofstream cannot drop buffered data, fork handling is not supported
+}
+
 result serializer::write(const char* data, size_t size)
 {
     scoped_lock lock(s_file_mutex);
 
+    if (m_sink)
+    {
+        chunk data_chunk = { data, size };
+        return write_to_sink(&data_chunk, 1);
+    }
+
     m_report_file.write(data, size);
 
     return status();
 }
 
+result serializer::write(const chunk* chunks, size_t count)
+{
+    scoped_lock lock(s_file_mutex);
+
+    if (m_sink)
+    {
+        return write_to_sink(chunks, count);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_report_file.write(static_cast<const char*>(chunks[i].data), chunks[i].size);
+    }
+
+    return status();
+}
+
+#endif
+
 } // namespace perfometer
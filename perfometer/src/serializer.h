@@ -21,26 +21,120 @@ SOFTWARE. */
 #pragma once
 
 #include <perfometer/perfometer.h>
+#include <perfometer/sink.h>
+#include <atomic>
 #include <fstream>
+#include <vector>
+
+#if defined(__linux__)
+#   define PERFOMETER_FD_SERIALIZER
+#   include <sys/types.h>
+#endif
 
 namespace perfometer
 {
+    // writes report file, on Linux through raw file descriptor batching writes
+    // in aligned staging buffer, elsewhere through std::ofstream,
+    // or collects batches of write_batch_size bytes for sink set by open_sink()
     class serializer
     {
     public:
+        struct chunk
+        {
+            const void* data;
+            size_t size;
+        };
+
         serializer();
         ~serializer();
 
-        result open_file_stream(const char fileName[]);
+        result open_file_stream(const char fileName[], const configuration& config = configuration());
+        result open_sink(sink& output, const configuration& config = configuration());
         result flush();
         result close();
 
-        result status() { return m_report_file.fail() ? result::io_error : result::ok; }
+        // writes staged data to file without syncing, no-op for std::ofstream
+        result submit();
+
+        // closes report file and continues writing into new one under single lock, so
+        // other threads writing or flushing meanwhile see either file, not report sink
+        result reopen(const char file_name[], const configuration& config);
+
+        // bytes written into report file so far including staged ones, 0 for sink
+        size_t size();
+
+        result status();
 
         result write(const char* data, size_t size);
 
+        // writes chunks one after another under single lock, used to write whole page frame at once
+        result write(const chunk* chunks, size_t count);
+
+#if defined(PERFOMETER_FD_SERIALIZER)
+        // async-signal-safe writing for crash handler without taking the lock: stops regular writes,
+        // waits for write of another thread in progress and writes staged data,
+        // returns false if file is not usable, e.g. thread crashed while writing it, or sink is set
+        bool begin_crash_write();
+        result crash_write(const chunk* chunks, size_t count);
+        result end_crash_write();
+#endif
+
+        // reset in child process after fork(), not held across it as file writes take it
+        mutex& fork_mutex() { return s_file_mutex; }
+
+        // child process after fork(), drops staged data and closes its copy of file without writing
+        // or allocating, file stays with parent process
+        void abandon();
+
     private:
+        // s_file_mutex must be held
+        result open_file(const char file_name[], const configuration& config);
+        result close_file();
+
+        result write_to_sink(const chunk* chunks, size_t count);
+        result submit_to_sink();
+        result close_sink();
+
+        sink*                   m_sink = nullptr;
+        std::vector<uint8_t>    m_batch;
+        size_t                  m_batch_capacity = 0;
+        result                  m_sink_status = result::ok;
+
+#if defined(PERFOMETER_FD_SERIALIZER)
+        static constexpr size_t max_chunks = 4;
+
+        // marks thread writing file while holding the lock, refuses to write once crash handler took file over
+        class write_scope
+        {
+        public:
+            explicit write_scope(serializer& file);
+            ~write_scope();
+
+            bool allowed() const { return m_allowed; }
+
+        private:
+            serializer& m_file;
+            bool m_allowed;
+        };
+
+        result write_staged(bool sync);
+        result write_all(const chunk* chunks, size_t count);
+        void release_buffer();
+
+        int         m_fd = -1;
+        uint8_t*    m_buffer = nullptr;
+        size_t      m_capacity = 0;
+        size_t      m_size = 0;
+        off_t       m_offset = 0;
+        bool        m_direct_io = false;
+        file_sync   m_sync = file_sync::none;
+        result      m_status = result::ok;
+
+        std::atomic<bool>      m_crashed{false};
+        std::atomic<thread_id> m_writer{thread_id()};
+#else
         std::ofstream m_report_file;
+#endif
         mutex s_file_mutex;
     };
 
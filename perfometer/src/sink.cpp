@@ -0,0 +1,468 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/sink.h>
+#include <perfometer/compression.h>
+#include <perfometer/format.h>
+
+#if !defined(_WIN32)
+#   include <cerrno>
+#   include <cstring>
+#   include <fcntl.h>
+#   include <sys/socket.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#endif
+
+namespace perfometer {
+
+file_sink::file_sink(const char file_name[])
+    : m_file(file_name, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc)
+{
+}
+
+result file_sink::write(const void* data, size_t size)
+{
+    m_file.write(static_cast<const char*>(data), size);
+
+    return m_file.fail() ? result::io_error : result::ok;
+}
+
+result file_sink::flush()
+{
+    m_file.flush();
+
+    return m_file.fail() ? result::io_error : result::ok;
+}
+
+result file_sink::close()
+{
+    if (!m_file.is_open())
+    {
+        return m_file.fail() ? result::io_error : result::ok;
+    }
+
+    m_file.close();
+
+    return m_file.fail() ? result::io_error : result::ok;
+}
+
+result memory_sink::write(const void* data, size_t size)
+{
+    scoped_lock lock(m_mutex);
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+
+    return result::ok;
+}
+
+std::vector<uint8_t> memory_sink::data() const
+{
+    scoped_lock lock(m_mutex);
+
+    return m_data;
+}
+
+size_t memory_sink::take(std::vector<uint8_t>& output)
+{
+    scoped_lock lock(m_mutex);
+
+    const size_t size = m_data.size();
+
+    output.insert(output.end(), m_data.begin(), m_data.end());
+    m_data.clear();
+
+    return size;
+}
+
+#if !defined(_WIN32)
+
+fd_sink::fd_sink(int fd, bool owned)
+    : m_fd(fd)
+    , m_owned(owned)
+{
+}
+
+fd_sink::~fd_sink()
+{
+    close();
+}
+
+result fd_sink::write(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    // pipe takes at most its capacity at once
+    while (size)
+    {
+        ssize_t written = ::write(m_fd, bytes, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return result::io_error;
+        }
+
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+
+    return result::ok;
+}
+
+result fd_sink::close()
+{
+    if (!m_owned || m_fd < 0)
+    {
+        return result::ok;
+    }
+
+    const int fd = m_fd;
+    m_fd = -1;
+
+    return ::close(fd) == 0 ? result::ok : result::io_error;
+}
+
+namespace {
+
+bool send_all(int socket, const uint8_t* data, size_t size)
+{
+    while (size)
+    {
+        ssize_t sent = ::send(socket, data, size, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+
+    return true;
+}
+
+// size of record of current version inside page, 0 if size bytes do not hold whole record
+// or record type is unknown
+size_t page_record_size(const uint8_t* data, size_t size, size_t thread_id_size)
+{
+    size_t offset = 1;
+    uint64_t value = 0;
+
+    auto skip_varints = [&](size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t varint_size = offset < size ? format::read_varint(data + offset, size - offset, value) : 0;
+            if (varint_size == 0)
+            {
+                return false;
+            }
+
+            offset += varint_size;
+        }
+
+        return true;
+    };
+
+    auto skip_bytes = [&](uint64_t count)
+    {
+        offset += count;
+        return offset <= size;
+    };
+
+    bool complete = false;
+
+    switch (data[0])
+    {
+        case format::record_type::string:
+        case format::record_type::dynamic_string:
+            // id, then length followed by string data
+            complete = skip_varints(2) && skip_bytes(value);
+            break;
+        case format::record_type::thread_name:
+            complete = skip_bytes(thread_id_size) && skip_varints(1);
+            break;
+        case format::record_type::work:
+        case format::record_type::wait:
+        case format::record_type::counter:
+        case format::record_type::flow_begin:
+        case format::record_type::flow_step:
+        case format::record_type::flow_end:
+            complete = skip_varints(3);
+            break;
+        case format::record_type::event:
+        case format::record_type::suppressed:
+            complete = skip_varints(2);
+            break;
+        case format::record_type::gauge:
+            complete = skip_varints(2) && skip_bytes(sizeof(double));
+            break;
+        case format::record_type::dynamic_string_ref:
+            complete = skip_varints(1);
+            break;
+        case format::record_type::arguments:
+        {
+            complete = skip_bytes(1);
+
+            const uint8_t count = complete ? data[1] : 0;
+            for (uint8_t i = 0; complete && i < count; ++i)
+            {
+                const argument_type type = offset < size ? static_cast<argument_type>(data[offset]) : argument_type::integer;
+
+                complete = skip_bytes(1) && skip_varints(1) &&
+                           (type == argument_type::real ? skip_bytes(sizeof(double)) : skip_varints(1));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return complete ? offset : 0;
+}
+
+} // namespace
+
+socket_sink::socket_sink(const char path[], uint32_t send_timeout_ms)
+    : m_path(path)
+    , m_listener(-1)
+    , m_send_timeout_ms(send_timeout_ms)
+    , m_time_size(0)
+    , m_thread_id_size(0)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (m_path.size() >= sizeof(address.sun_path))
+    {
+        return;
+    }
+
+    std::memcpy(address.sun_path, m_path.c_str(), m_path.size() + 1);
+
+    m_listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listener < 0)
+    {
+        return;
+    }
+
+    // socket file left by previous run
+    ::unlink(m_path.c_str());
+
+    if (::bind(m_listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(m_listener, SOMAXCONN) != 0)
+    {
+        ::close(m_listener);
+        m_listener = -1;
+    }
+}
+
+socket_sink::~socket_sink()
+{
+    close();
+}
+
+void socket_sink::accept_clients()
+{
+    int client;
+    while ((client = ::accept4(m_listener, nullptr, nullptr, SOCK_CLOEXEC)) >= 0)
+    {
+        timeval timeout = {};
+        timeout.tv_sec = m_send_timeout_ms / 1000;
+        timeout.tv_usec = (m_send_timeout_ms % 1000) * 1000;
+
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        if (send_all(client, m_catalog.data(), m_catalog.size()))
+        {
+            m_clients.push_back(client);
+        }
+        else
+        {
+            ::close(client);
+        }
+    }
+}
+
+// keeps records every client needs to read pages, batches hold whole frames
+void socket_sink::catalog(const uint8_t* data, size_t size)
+{
+    if (m_catalog.empty() && size >= format::header_size)
+    {
+        m_catalog.insert(m_catalog.end(), data, data + format::header_size);
+
+        data += format::header_size;
+        size -= format::header_size;
+    }
+
+    while (size)
+    {
+        const format::record_type type = static_cast<format::record_type>(data[0]);
+        if (!format::top_level_record(type))
+        {
+            break;
+        }
+
+        const size_t record_size = format::top_level_record_size(data, size, m_thread_id_size);
+        if (record_size == 0)
+        {
+            break;
+        }
+
+        switch (type)
+        {
+            case format::record_type::page:
+            {
+                // page record type and size, page data, page_end
+                catalog_page(data + 3, record_size - 4);
+                break;
+            }
+            case format::record_type::page_compressed:
+            {
+                uint16_t page_size = 0;
+                std::memcpy(&page_size, data + 3, sizeof(page_size));
+
+                m_page.resize(page_size);
+                if (compression::decompress(data + 5, record_size - 6, m_page.data(), page_size) == page_size)
+                {
+                    catalog_page(m_page.data(), page_size);
+                }
+                break;
+            }
+            default:
+            {
+                if (type == format::record_type::clock_configuration)
+                {
+                    m_time_size = data[1];
+                }
+                else if (type == format::record_type::thread_info)
+                {
+                    m_thread_id_size = data[1];
+                }
+
+                m_catalog.insert(m_catalog.end(), data, data + record_size);
+                break;
+            }
+        }
+
+        data += record_size;
+        size -= record_size;
+    }
+}
+
+// strings registered and threads named after initialize are written into pages,
+// their records have the same layout at top level
+void socket_sink::catalog_page(const uint8_t* data, size_t size)
+{
+    // page thread id and base time
+    const size_t page_header = m_thread_id_size + m_time_size;
+    if (size < page_header)
+    {
+        return;
+    }
+
+    data += page_header;
+    size -= page_header;
+
+    while (size)
+    {
+        const size_t record_size = page_record_size(data, size, m_thread_id_size);
+        if (record_size == 0)
+        {
+            break;
+        }
+
+        if (data[0] == format::record_type::string || data[0] == format::record_type::thread_name)
+        {
+            m_catalog.insert(m_catalog.end(), data, data + record_size);
+        }
+
+        data += record_size;
+        size -= record_size;
+    }
+}
+
+// client failing to take whole data is disconnected as it would be left inside frame
+void socket_sink::send_to_clients(const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < m_clients.size(); )
+    {
+        if (send_all(m_clients[i], data, size))
+        {
+            ++i;
+            continue;
+        }
+
+        ::close(m_clients[i]);
+        m_clients.erase(m_clients.begin() + i);
+    }
+}
+
+result socket_sink::write(const void* data, size_t size)
+{
+    if (m_listener < 0)
+    {
+        return result::io_error;
+    }
+
+    // clients connected meanwhile get catalog of previous batches, then this batch
+    accept_clients();
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    catalog(bytes, size);
+    send_to_clients(bytes, size);
+
+    return result::ok;
+}
+
+result socket_sink::close()
+{
+    for (int client : m_clients)
+    {
+        ::close(client);
+    }
+
+    m_clients.clear();
+
+    if (m_listener >= 0)
+    {
+        ::close(m_listener);
+        m_listener = -1;
+
+        ::unlink(m_path.c_str());
+    }
+
+    return result::ok;
+}
+
+#endif
+
+} // namespace perfometer
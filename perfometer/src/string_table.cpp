@@ -0,0 +1,113 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "string_table.h"
+#include <perfometer/format.h>
+#include <cstring>
+
+namespace perfometer {
+
+constexpr size_t string_table::bucket_count;
+constexpr string_id string_table::first_id;
+
+static uint64_t content_hash(const char* string, size_t len)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash = (hash ^ static_cast<uint8_t>(string[i])) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+string_table::string_table()
+    : m_size(0)
+    , m_next_id(first_id)
+{
+    for (auto& bucket : m_buckets)
+    {
+        bucket.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+string_id string_table::intern(const char* string, size_t len, bool& inserted)
+{
+    inserted = false;
+
+    const uint64_t hash = content_hash(string, len);
+
+    const entry* found = find(hash, string, len);
+    if (found)
+    {
+        return found->id;
+    }
+
+    scoped_lock lock(m_mutex);
+
+    // may have been inserted by other thread while lock was taken
+    found = find(hash, string, len);
+    if (found)
+    {
+        return found->id;
+    }
+
+    const string_id str_id = m_next_id.fetch_add(1, std::memory_order_relaxed);
+    if (str_id >= format::static_string_id_base)
+    {
+        m_next_id.store(format::static_string_id_base, std::memory_order_relaxed);
+        return format::invalid_string_id;
+    }
+
+    std::atomic<entry*>& bucket = m_buckets[hash % bucket_count];
+
+    m_entries.push_back(entry{hash, str_id, std::string(string, len), bucket.load(std::memory_order_relaxed)});
+    bucket.store(&m_entries.back(), std::memory_order_release);
+    m_size.store(m_entries.size(), std::memory_order_release);
+
+    inserted = true;
+
+    return str_id;
+}
+
+string_id string_table::find(const char* string, size_t len) const
+{
+    const entry* found = find(content_hash(string, len), string, len);
+    return found ? found->id : format::invalid_string_id;
+}
+
+const string_table::entry* string_table::find(uint64_t hash, const char* string, size_t len) const
+{
+    const entry* e = m_buckets[hash % bucket_count].load(std::memory_order_acquire);
+    for (; e; e = e->next)
+    {
+        if (e->hash == hash &&
+            e->string.size() == len &&
+            std::memcmp(e->string.data(), string, len) == 0)
+        {
+            return e;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace perfometer
@@ -0,0 +1,90 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <perfometer/perfometer.h>
+
+#include <atomic>
+#include <deque>
+#include <string>
+
+namespace perfometer
+{
+    // interning table of registered strings, same content always gets same id
+    // lookups are lock free, inserts are serialized, entries live until table is destroyed
+    class string_table
+    {
+    public:
+        static constexpr size_t bucket_count = 4096;
+        static constexpr string_id first_id = 2; // 0 - "UNKNOWN", 1 - dynamic string marker
+
+        string_table();
+
+        string_table(const string_table&) = delete;
+        string_table& operator = (const string_table&) = delete;
+
+        // returns id of string, or format::invalid_string_id when ids are exhausted
+        // inserted is set when string is seen first time and caller should write string record
+        string_id intern(const char* string, size_t len, bool& inserted);
+
+        // returns id of string or format::invalid_string_id if string is not registered
+        string_id find(const char* string, size_t len) const;
+
+        size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+        // held across fork() so child process inherits table in consistent state
+        mutex& fork_mutex() { return m_mutex; }
+
+        // calls func(string_id, const std::string&) for every entry from first on in registration order,
+        // returns number of entries
+        template<typename Func>
+        size_t for_each(Func func, size_t first = 0) const
+        {
+            scoped_lock lock(m_mutex);
+
+            for (size_t i = first; i < m_entries.size(); ++i)
+            {
+                func(m_entries[i].id, m_entries[i].string);
+            }
+
+            return m_entries.size();
+        }
+
+    private:
+        struct entry
+        {
+            uint64_t        hash;
+            string_id       id;
+            std::string     string;
+            entry*          next;   // immutable once entry is published
+        };
+
+        const entry* find(uint64_t hash, const char* string, size_t len) const;
+
+    private:
+        std::atomic<entry*>     m_buckets[bucket_count];
+        std::deque<entry>       m_entries;
+        std::atomic<size_t>     m_size;
+        std::atomic<string_id>  m_next_id;
+        mutable mutex           m_mutex;
+    };
+
+} // namespace perfometer
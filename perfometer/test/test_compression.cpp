@@ -0,0 +1,134 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <perfometer/compression.h>
+#include <iostream>
+#include <vector>
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+size_t check_round_trip(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> compressed(perfometer::compression::max_compressed_size(data.size()));
+    std::vector<uint8_t> decompressed(data.size());
+
+    size_t compressed_size = perfometer::compression::compress(data.data(), data.size(),
+                                                               compressed.data(), compressed.size());
+    CHECK(compressed_size != 0, true);
+
+    size_t decompressed_size = perfometer::compression::decompress(compressed.data(), compressed_size,
+                                                                   decompressed.data(), decompressed.size());
+    CHECK(decompressed_size, data.size());
+    CHECK(decompressed == data, true);
+
+    return compressed_size;
+}
+
+void check_small_inputs()
+{
+    for (size_t size = 1; size < 32; ++size)
+    {
+        check_round_trip(std::vector<uint8_t>(size, 7));
+    }
+}
+
+void check_repeating_records()
+{
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 4000; ++i)
+    {
+        data.push_back(5);
+        data.push_back(static_cast<uint8_t>(i % 3));
+        data.push_back(0);
+        data.push_back(static_cast<uint8_t>(i % 11));
+    }
+
+    data.resize(4048);
+
+    size_t compressed_size = check_round_trip(data);
+    CHECK(compressed_size < data.size() / 4, true);
+}
+
+void check_long_runs()
+{
+    // lengths past 15 + 255 exercise token length extension bytes
+    std::vector<uint8_t> data(600, 1);
+    for (size_t i = 0; i < 600; ++i)
+    {
+        data.push_back(static_cast<uint8_t>(i * 7919 >> 3));
+    }
+
+    check_round_trip(data);
+}
+
+void check_incompressible()
+{
+    std::vector<uint8_t> data(4048);
+    uint32_t state = 12345;
+    for (auto& byte : data)
+    {
+        state = state * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(state >> 16);
+    }
+
+    size_t compressed_size = check_round_trip(data);
+    CHECK(compressed_size <= perfometer::compression::max_compressed_size(data.size()), true);
+
+    // output does not fit, compression reports failure instead of overflowing
+    std::vector<uint8_t> small(data.size() / 2);
+    CHECK(perfometer::compression::compress(data.data(), data.size(), small.data(), small.size()), 0);
+}
+
+void check_malformed()
+{
+    uint8_t output[64];
+
+    // offset pointing before start of output
+    const uint8_t bad_offset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    CHECK(perfometer::compression::decompress(bad_offset, sizeof(bad_offset), output, sizeof(output)), 0);
+
+    // literals past end of input
+    const uint8_t truncated[] = { 0x50, 'a', 'b' };
+    CHECK(perfometer::compression::decompress(truncated, sizeof(truncated), output, sizeof(output)), 0);
+
+    // match past end of output
+    const uint8_t overflow[] = { 0x1F, 'a', 0x01, 0x00, 0xFF, 0xFF, 0x00, 0x00 };
+    CHECK(perfometer::compression::decompress(overflow, sizeof(overflow), output, sizeof(output)), 0);
+}
+
+int main(int argc, const char** argv)
+{
+    check_small_inputs();
+    check_repeating_records();
+    check_long_runs();
+    check_incompressible();
+    check_malformed();
+
+    return result;
+}
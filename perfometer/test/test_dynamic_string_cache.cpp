@@ -0,0 +1,104 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "../src/dynamic_string_cache.h"
+#include <iostream>
+#include <string>
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+uint32_t insert(perfometer::dynamic_string_cache& cache, const std::string& string, bool& cached)
+{
+    return cache.insert(string.c_str(), string.size(), cached);
+}
+
+void check_repeats()
+{
+    perfometer::dynamic_string_cache cache;
+    CHECK(cache.size(), 0);
+
+    bool cached = true;
+    uint32_t get = insert(cache, "GET /index", cached);
+    CHECK(cached, false);
+    CHECK(get, 0);
+
+    uint32_t post = insert(cache, "POST /form", cached);
+    CHECK(cached, false);
+    CHECK(post, 1);
+
+    CHECK(insert(cache, "GET /index", cached), get);
+    CHECK(cached, true);
+    CHECK(insert(cache, "POST /form", cached), post);
+    CHECK(cached, true);
+    CHECK(cache.size(), 2);
+
+    cache.clear();
+    CHECK(cache.size(), 0);
+    CHECK(insert(cache, "POST /form", cached), 0);
+    CHECK(cached, false);
+}
+
+void check_eviction()
+{
+    constexpr uint32_t capacity = perfometer::dynamic_string_cache::capacity;
+
+    perfometer::dynamic_string_cache cache;
+    bool cached = false;
+
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+        CHECK(insert(cache, std::to_string(i), cached), i);
+    }
+
+    CHECK(cache.size(), capacity);
+
+    // "0" becomes most recently used, so "1" is evicted by new string and its id reused
+    CHECK(insert(cache, "0", cached), 0);
+    CHECK(cached, true);
+
+    CHECK(insert(cache, "new", cached), 1);
+    CHECK(cached, false);
+    CHECK(cache.size(), capacity);
+
+    CHECK(insert(cache, "1", cached), 2);
+    CHECK(cached, false);
+
+    CHECK(insert(cache, "0", cached), 0);
+    CHECK(cached, true);
+    CHECK(insert(cache, "new", cached), 1);
+    CHECK(cached, true);
+}
+
+int main(int argc, const char** argv)
+{
+    check_repeats();
+    check_eviction();
+
+    return result;
+}
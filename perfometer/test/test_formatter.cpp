@@ -20,6 +20,7 @@ SOFTWARE. */
 
 #include "../src/formatter.h"
 #include <vector>
+#include <string>
 #include <iostream>
 
 template<typename T1, typename T2>
@@ -111,13 +112,99 @@ void check_formatting_string2()
     CHECK(std::memcmp(s.data() + 1, dummy_string, strlen(dummy_string)), 0);
 }
 
+void check_formatting_long_string()
+{
+    const std::string long_string(300, 'x');
+    stream_stub s;
+    perfometer::formatter<stream_stub> fmt(s);
+    fmt.write_string(long_string.c_str(), long_string.size());
+
+    // varint length 300
+    CHECK(s.size(), 2 + long_string.size());
+    CHECK(int(s[0]), (0x80 | (300 & 0x7f)));
+    CHECK(int(s[1]), 300 >> 7);
+    CHECK(std::memcmp(s.data() + 2, long_string.data(), long_string.size()), 0);
+}
+
+void check_formatting_varint(uint64_t value, size_t expected_size)
+{
+    stream_stub s;
+    perfometer::formatter<stream_stub> fmt(s);
+    fmt.write_varint(value);
+
+    CHECK(s.size(), expected_size);
+
+    uint64_t decoded = 0;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        decoded |= static_cast<uint64_t>(s[i] & 0x7f) << (7 * i);
+        CHECK((s[i] & 0x80) != 0, i + 1 < s.size());
+    }
+
+    CHECK(decoded, value);
+}
+
+void check_formatting_time_delta(perfometer::time t, perfometer::time base, size_t expected_size)
+{
+    stream_stub s;
+    perfometer::formatter<stream_stub> fmt(s);
+    fmt.write_time_delta(t, base);
+
+    CHECK(s.size(), expected_size);
+
+    uint64_t decoded = 0;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        decoded |= static_cast<uint64_t>(s[i] & 0x7f) << (7 * i);
+    }
+
+    CHECK(base + perfometer::format::zigzag_decode(decoded), t);
+}
+
+void check_formatting_string_id(perfometer::string_id id, size_t expected_size)
+{
+    stream_stub s;
+    perfometer::formatter<stream_stub> fmt(s);
+    fmt << id;
+
+    CHECK(s.size(), expected_size);
+
+    uint64_t decoded = 0;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        decoded |= static_cast<uint64_t>(s[i] & 0x7f) << (7 * i);
+    }
+
+    CHECK(decoded, id);
+}
+
 int main(int argc, const char** argv)
 {
     check_formatting(perfometer::format::record_type::clock_configuration);
-    check_formatting(perfometer::string_id(1557));
+    check_formatting(uint16_t(1557));
     check_formatting(perfometer::time(178976));
+    check_formatting(2.5);
     check_formatting_size(perfometer::thread_id());
     check_formatting_string();
+    check_formatting_long_string();
+
+    check_formatting_varint(0, 1);
+    check_formatting_varint(127, 1);
+    check_formatting_varint(128, 2);
+    check_formatting_varint(16383, 2);
+    check_formatting_varint(16384, 3);
+    check_formatting_varint(std::numeric_limits<uint64_t>::max(), perfometer::format::max_varint_size);
+
+    check_formatting_time_delta(1000000, 1000000, 1);
+    check_formatting_time_delta(999999, 1000000, 1);
+    check_formatting_time_delta(1000063, 1000000, 1);
+    check_formatting_time_delta(1000064, 1000000, 2);
+    check_formatting_time_delta(0, 1000000, 3);
+
+    check_formatting_string_id(perfometer::format::dynamic_string_id, 1);
+    check_formatting_string_id(1557, 2);
+    check_formatting_string_id(perfometer::format::static_string_id_base, 5);
+    check_formatting_string_id(perfometer::format::invalid_string_id, 5);
 
     return result;
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "../src/record_filter.h"
+#include <iostream>
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+void check_sampling()
+{
+    perfometer::record_filter filter;
+    CHECK(filter.empty(), true);
+    CHECK(filter.find(5), perfometer::record_filter::npos);
+
+    CHECK(filter.set_sampling(5, 0), perfometer::result::invalid_arguments);
+    CHECK(filter.set_sampling(5, 10), perfometer::result::ok);
+    CHECK(filter.empty(), false);
+
+    size_t slot = filter.find(5);
+    CHECK(slot != perfometer::record_filter::npos, true);
+    CHECK(filter.id(slot), 5);
+    CHECK(filter.find(6), perfometer::record_filter::npos);
+
+    uint32_t counter = 0;
+    int accepted = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        accepted += filter.accept(slot, counter, i) ? 1 : 0;
+    }
+
+    CHECK(accepted, 100);
+
+    // first record of thread is always kept
+    uint32_t other_thread_counter = 0;
+    CHECK(filter.accept(slot, other_thread_counter, 0), true);
+
+    CHECK(filter.set_sampling(5, 1), perfometer::result::ok);
+    CHECK(filter.accept(slot, counter, 0), true);
+    CHECK(filter.accept(slot, counter, 0), true);
+}
+
+void check_rate_limit()
+{
+    perfometer::record_filter filter;
+
+    const perfometer::time frequency = perfometer::get_clock_frequency();
+
+    // 10 records per second with bursts of 5
+    CHECK(filter.set_rate_limit(7, 10, 5), perfometer::result::ok);
+
+    size_t slot = filter.find(7);
+    uint32_t counter = 0;
+
+    const perfometer::time start = frequency * 100;
+
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        accepted += filter.accept(slot, counter, start) ? 1 : 0;
+    }
+
+    CHECK(accepted, 5);
+
+    // one second later 10 more records fit, spread evenly
+    accepted = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        accepted += filter.accept(slot, counter, start + frequency + frequency * i / 1000) ? 1 : 0;
+    }
+
+    CHECK(accepted >= 10 && accepted <= 15, true);
+
+    CHECK(filter.set_rate_limit(7, 0, 1), perfometer::result::ok);
+    CHECK(filter.accept(slot, counter, start), true);
+}
+
+void check_min_duration()
+{
+    perfometer::record_filter filter;
+
+    CHECK(filter.set_min_duration(9, -1), perfometer::result::invalid_arguments);
+    CHECK(filter.set_min_duration(9, 1000), perfometer::result::ok);
+
+    size_t slot = filter.find(9);
+    CHECK(filter.min_duration(slot), 1000);
+
+    // minimum duration does not affect sampling and rate limit of the name
+    uint32_t counter = 0;
+    CHECK(filter.accept(slot, counter, 0), true);
+
+    CHECK(filter.set_sampling(9, 2), perfometer::result::ok);
+    CHECK(filter.find(9), slot);
+    CHECK(filter.min_duration(slot), 1000);
+}
+
+void check_capacity()
+{
+    perfometer::record_filter filter;
+
+    for (size_t i = 0; i < perfometer::record_filter::capacity; ++i)
+    {
+        CHECK(filter.set_sampling(static_cast<perfometer::string_id>(i * 3), 2), perfometer::result::ok);
+    }
+
+    CHECK(filter.set_sampling(1, 2), perfometer::result::overflow);
+
+    for (size_t i = 0; i < perfometer::record_filter::capacity; ++i)
+    {
+        size_t slot = filter.find(static_cast<perfometer::string_id>(i * 3));
+        CHECK(filter.id(slot), i * 3);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    check_sampling();
+    check_rate_limit();
+    check_min_duration();
+    check_capacity();
+
+    return result;
+}
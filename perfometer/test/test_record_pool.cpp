@@ -0,0 +1,133 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "../src/record_pool.h"
+#include <atomic>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+void check_limited_pool()
+{
+    perfometer::record_pool pool;
+    CHECK(pool.reserve(100), perfometer::result::ok);
+    CHECK(pool.allocated(), 100);
+
+    std::set<perfometer::record_buffer*> pages;
+    for (int i = 0; i < 100; ++i)
+    {
+        perfometer::record_buffer* page = pool.acquire();
+        CHECK(page != nullptr, true);
+        pages.insert(page);
+    }
+
+    CHECK(pages.size(), 100);
+    CHECK(pool.acquire() == nullptr, true);
+    CHECK(pool.allocated(), 100);
+
+    perfometer::record_buffer* page = *pages.begin();
+    const uint8_t byte = 42;
+    page->write(&byte, 1);
+    pool.release(page);
+
+    page = pool.acquire();
+    CHECK(pages.count(page), 1);
+    CHECK(page->used_size(), 0);
+}
+
+void check_unlimited_pool()
+{
+    perfometer::record_pool pool;
+    CHECK(pool.allocated(), 0);
+
+    perfometer::record_buffer* page = pool.acquire();
+    CHECK(page != nullptr, true);
+    CHECK(pool.allocated(), perfometer::record_pool::chunk_size);
+
+    pool.release(page);
+    CHECK(pool.acquire(), page);
+}
+
+void check_concurrent_recycling()
+{
+    constexpr int num_threads = 8;
+    constexpr int num_iterations = 100000;
+
+    perfometer::record_pool pool;
+    pool.reserve(num_threads);
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&pool, &failures, t]()
+        {
+            const uint8_t byte = static_cast<uint8_t>(t);
+
+            for (int i = 0; i < num_iterations; ++i)
+            {
+                perfometer::record_buffer* page = pool.acquire();
+                if (!page)
+                {
+                    failures++;
+                    continue;
+                }
+
+                page->write(&byte, 1);
+                if (page->used_size() != 1 || page->data()[0] != byte)
+                {
+                    failures++;
+                }
+
+                pool.release(page);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(failures, 0);
+    CHECK(pool.allocated(), num_threads);
+}
+
+int main(int argc, const char** argv)
+{
+    check_limited_pool();
+    check_unlimited_pool();
+    check_concurrent_recycling();
+
+    return result;
+}
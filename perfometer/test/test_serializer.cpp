@@ -0,0 +1,299 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "../src/serializer.h"
+#include <perfometer/format.h>
+#include <perfometer/sink.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#   include <unistd.h>
+#endif
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+std::vector<char> read_file(const char* file_name)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// writes page like frames of varying size crossing batch boundaries, file has to match written bytes
+void check_batched_writes(bool direct_io, perfometer::file_sync sync)
+{
+    const char* file_name = "test_serializer.report";
+
+    perfometer::configuration config;
+    config.write_batch_size = 4096;
+    config.direct_io = direct_io;
+    config.sync = sync;
+
+    perfometer::serializer serializer;
+    CHECK(serializer.open_file_stream(file_name, config), perfometer::result::ok);
+
+    std::vector<char> expected;
+    std::vector<char> page(5000);
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        const char header[] = { 8, static_cast<char>(i), static_cast<char>(i >> 8) };
+        const char page_end = 9;
+        const size_t page_size = (i * 997) % page.size();
+
+        for (size_t b = 0; b < page_size; ++b)
+        {
+            page[b] = static_cast<char>(i + b);
+        }
+
+        const perfometer::serializer::chunk frame[] = { { header, sizeof(header) },
+                                                        { page.data(), page_size },
+                                                        { &page_end, 1 } };
+        CHECK(serializer.write(frame, 3), perfometer::result::ok);
+
+        expected.insert(expected.end(), header, header + sizeof(header));
+        expected.insert(expected.end(), page.begin(), page.begin() + page_size);
+        expected.push_back(page_end);
+
+        if (i % 50 == 0)
+        {
+            CHECK(serializer.flush(), perfometer::result::ok);
+            CHECK(read_file(file_name).size() >= expected.size(), true);
+        }
+
+        if (i % 70 == 0)
+        {
+            CHECK(serializer.submit(), perfometer::result::ok);
+        }
+    }
+
+    CHECK(serializer.write("tail", 4), perfometer::result::ok);
+    expected.insert(expected.end(), { 't', 'a', 'i', 'l' });
+
+    CHECK(serializer.close(), perfometer::result::ok);
+
+    std::vector<char> written = read_file(file_name);
+    CHECK(written.size(), expected.size());
+    CHECK(written == expected, true);
+}
+
+// keeps each batch separately to check batch boundaries
+struct batch_sink : perfometer::sink
+{
+    perfometer::result write(const void* data, size_t size) override
+    {
+        const char* bytes = static_cast<const char*>(data);
+        batches.emplace_back(bytes, bytes + size);
+        return perfometer::result::ok;
+    }
+
+    perfometer::result close() override
+    {
+        closed = true;
+        return perfometer::result::ok;
+    }
+
+    std::vector<std::vector<char>> batches;
+    bool closed = false;
+};
+
+// sink gets whole frames in batches up to batch size, not a call per frame
+void check_sink_batches()
+{
+    perfometer::configuration config;
+    config.write_batch_size = 16384;
+
+    batch_sink sink;
+
+    perfometer::serializer serializer;
+    CHECK(serializer.open_sink(sink, config), perfometer::result::ok);
+
+    std::vector<char> expected;
+    std::vector<char> page(4000);
+    std::vector<size_t> frame_ends;
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        const char header = 8;
+        const size_t page_size = (i * 997) % page.size();
+
+        const perfometer::serializer::chunk frame[] = { { &header, 1 }, { page.data(), page_size } };
+        CHECK(serializer.write(frame, 2), perfometer::result::ok);
+
+        expected.push_back(header);
+        expected.insert(expected.end(), page.begin(), page.begin() + page_size);
+        frame_ends.push_back(expected.size());
+    }
+
+    CHECK(serializer.close(), perfometer::result::ok);
+    CHECK(sink.closed, true);
+    CHECK(sink.batches.size() < 200 / 2, true);
+
+    std::vector<char> written;
+    for (const auto& batch : sink.batches)
+    {
+        CHECK(batch.size() <= config.write_batch_size, true);
+
+        written.insert(written.end(), batch.begin(), batch.end());
+
+        bool frame_end = false;
+        for (size_t end : frame_ends)
+        {
+            frame_end |= end == written.size();
+        }
+
+        CHECK(frame_end, true);
+    }
+
+    CHECK(written == expected, true);
+}
+
+bool is_report(const std::vector<uint8_t>& data)
+{
+    const size_t header_size = sizeof(perfometer::format::header) - 1;
+    return data.size() > header_size && std::memcmp(data.data(), perfometer::format::header, header_size) == 0;
+}
+
+void log_events(perfometer::session& session, int count)
+{
+    const perfometer::string_id name_id = perfometer::register_string("sink");
+
+    for (int i = 0; i < count; ++i)
+    {
+        session.log_event(name_id, perfometer::get_time());
+    }
+}
+
+void check_memory_sink()
+{
+    perfometer::memory_sink sink;
+
+    perfometer::configuration config;
+    config.report_sink = &sink;
+
+    perfometer::session session;
+    CHECK(session.initialize(config), perfometer::result::ok);
+
+    log_events(session, 10000);
+
+    CHECK(session.shutdown(), perfometer::result::ok);
+
+    // each event record takes at least 3 bytes
+    std::vector<uint8_t> report;
+    CHECK(sink.take(report) > 10000 * 3, true);
+    CHECK(is_report(report), true);
+    CHECK(sink.data().empty(), true);
+}
+
+void check_file_sink()
+{
+    const char* file_name = "test_file_sink.report";
+
+    {
+        perfometer::file_sink sink(file_name);
+
+        perfometer::configuration config;
+        config.report_sink = &sink;
+
+        perfometer::session session;
+        CHECK(session.initialize(config), perfometer::result::ok);
+
+        log_events(session, 10000);
+
+        CHECK(session.shutdown(), perfometer::result::ok);
+    }
+
+    std::vector<char> written = read_file(file_name);
+    CHECK(is_report(std::vector<uint8_t>(written.begin(), written.end())), true);
+    CHECK(written.size() > 10000 * 3, true);
+}
+
+#if !defined(_WIN32)
+// report streamed through pipe to reader running alongside, reader sees end of file on shutdown
+void check_fd_sink()
+{
+    int fds[2];
+    CHECK(pipe(fds), 0);
+
+    std::vector<uint8_t> received;
+    std::thread reader([&received, &fds]()
+    {
+        uint8_t buffer[4096];
+
+        ssize_t size;
+        while ((size = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            received.insert(received.end(), buffer, buffer + size);
+        }
+
+        close(fds[0]);
+    });
+
+    {
+        perfometer::fd_sink sink(fds[1], true);
+
+        perfometer::configuration config;
+        config.report_sink = &sink;
+
+        perfometer::session session;
+        CHECK(session.initialize(config), perfometer::result::ok);
+
+        log_events(session, 10000);
+
+        CHECK(session.shutdown(), perfometer::result::ok);
+    }
+
+    reader.join();
+
+    CHECK(is_report(received), true);
+    CHECK(received.size() > 10000 * 3, true);
+}
+#endif
+
+int main(int argc, const char** argv)
+{
+    check_batched_writes(false, perfometer::file_sync::none);
+    check_batched_writes(false, perfometer::file_sync::every_write);
+    check_batched_writes(true, perfometer::file_sync::on_flush);
+    check_batched_writes(true, perfometer::file_sync::none);
+
+    check_sink_batches();
+    check_memory_sink();
+    check_file_sink();
+
+#if !defined(_WIN32)
+    check_fd_sink();
+#endif
+
+    return result;
+}
@@ -20,9 +20,26 @@ SOFTWARE. */
 
 #include <perfometer/perfometer.h>
 #include <perfometer/helpers.h>
+#include <perfometer/format.h>
+#include <atomic>
+#include <cstring>
 #include <ctime>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <fstream>
 #include <iostream>
+#include <string>
 #include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#   include <cstdio>
+#   include <csignal>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif
 
 constexpr int num_threads = 10;
 std::thread threads[num_threads];
@@ -148,11 +165,525 @@ void test_start_stop_repeat()
     wait_work_threads();
 }
 
+// event records by name in uncompressed pages of report written by this process and ids
+// of string records, complete if report ends with whole record
+struct report_contents
+{
+    std::map<perfometer::string_id, size_t> events;
+    std::set<perfometer::string_id> strings;
+    bool complete = false;
+};
+
+// size of page record logged by tests here, 0 if size bytes do not hold whole record
+// or record type is not one of them
+size_t page_record_size(const uint8_t* data, size_t size, size_t thread_id_size)
+{
+    size_t offset = 1;
+    uint64_t value = 0;
+
+    auto skip_varints = [&](size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t varint_size = offset < size ? perfometer::format::read_varint(data + offset, size - offset, value) : 0;
+            if (varint_size == 0)
+            {
+                return false;
+            }
+
+            offset += varint_size;
+        }
+
+        return true;
+    };
+
+    bool complete = false;
+
+    switch (data[0])
+    {
+        case perfometer::format::record_type::dynamic_string:
+            // transient id, then length followed by string data
+            complete = skip_varints(2) && (offset += value) <= size;
+            break;
+        case perfometer::format::record_type::dynamic_string_ref:
+            complete = skip_varints(1);
+            break;
+        case perfometer::format::record_type::thread_name:
+            offset += thread_id_size;
+            complete = offset <= size && skip_varints(1);
+            break;
+        case perfometer::format::record_type::work:
+        case perfometer::format::record_type::wait:
+            complete = skip_varints(3);
+            break;
+        case perfometer::format::record_type::event:
+            complete = skip_varints(2);
+            break;
+        default:
+            break;
+    }
+
+    return complete ? offset : 0;
+}
+
+report_contents read_report(const char* file_name)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    report_contents contents;
+
+    const size_t thread_id_size = sizeof(perfometer::thread_id);
+    const size_t page_header = 1 + sizeof(uint16_t);
+
+    size_t offset = perfometer::format::header_size;
+    while (offset < data.size())
+    {
+        const uint8_t* record = data.data() + offset;
+        const size_t record_size = perfometer::format::top_level_record_size(record, data.size() - offset, thread_id_size);
+        if (record_size == 0)
+        {
+            return contents;
+        }
+
+        uint64_t str_id = 0;
+        if (record[0] == perfometer::format::record_type::string &&
+            perfometer::format::read_varint(record + 1, record_size - 1, str_id))
+        {
+            contents.strings.insert(static_cast<perfometer::string_id>(str_id));
+        }
+
+        if (record[0] == perfometer::format::record_type::page)
+        {
+            // page data starts with thread id and base time, page_end record follows it
+            const uint8_t* page = record + page_header + thread_id_size + sizeof(perfometer::time);
+            const uint8_t* page_end = record + record_size - 1;
+
+            while (page < page_end)
+            {
+                const size_t size = page_record_size(page, page_end - page, thread_id_size);
+                if (size == 0)
+                {
+                    return contents;
+                }
+
+                uint64_t str_id = 0;
+                if (page[0] == perfometer::format::record_type::event &&
+                    perfometer::format::read_varint(page + 1, size - 1, str_id))
+                {
+                    contents.events[static_cast<perfometer::string_id>(str_id)]++;
+                }
+
+                page += size;
+            }
+        }
+
+        offset += record_size;
+    }
+
+    contents.complete = offset == data.size();
+
+    return contents;
+}
+
+int test_thread_churn()
+{
+    const char* file_name = "test_thread_churn.report";
+
+    // exited threads keeping their pages would use budget up long before the last one runs
+    perfometer::configuration config;
+    config.file_name = file_name;
+    config.memory_budget = 256 * perfometer::records_cache_size;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    const perfometer::string_id name_id = perfometer::register_string("SHORT_LIVED");
+    const perfometer::string_id started_id = perfometer::register_string("started");
+
+    const int count = 1000;
+    std::atomic<int> logged(0);
+
+    // pages of exited threads are handed to logger on thread exit, not kept until shutdown
+    for (int i = 0; i < count; ++i)
+    {
+        std::thread thread([&]()
+        {
+            perfometer::log_thread_name(name_id);
+
+            if (perfometer::log_event(started_id, perfometer::get_time()) == perfometer::result::ok)
+            {
+                logged++;
+            }
+        });
+
+        thread.join();
+    }
+
+    result = perfometer::flush();
+    std::cout << "perfometer::flush() returned " << result << std::endl;
+
+    const report_contents flushed = read_report(file_name);
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    const report_contents report = read_report(file_name);
+
+    const size_t flushed_events = flushed.events.count(started_id) ? flushed.events.at(started_id) : 0;
+    const size_t events = report.events.count(started_id) ? report.events.at(started_id) : 0;
+
+    std::cout << "thread churn logged " << logged << " events, " << flushed_events << " in report before shutdown, "
+              << events << " after" << std::endl;
+
+    // names registered while session runs are written by logger, not to pages of registering thread
+    const bool named = report.strings.count(name_id) && report.strings.count(started_id);
+
+    const bool passed = result == perfometer::result::ok && report.complete && named &&
+                        logged == count && flushed_events == count && events == count;
+
+    return passed ? 0 : -1;
+}
+
+int test_page_reclaim()
+{
+    const char* file_name = "test_page_reclaim.report";
+
+    perfometer::configuration config;
+    config.file_name = file_name;
+    config.logger_max_latency_ms = 1;
+    config.page_max_age_ms = 1;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    // logger keeps taking pages of threads which pause between records
+    start_work_threads();
+    wait_work_threads();
+
+    const perfometer::string_id quiet_id = perfometer::register_string("quiet");
+    const size_t count = 100;
+    std::atomic<int> stage(0);
+
+    // thread goes quiet with partial page, then logs into new page once logger took it
+    std::thread quiet([&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            perfometer::log_event(quiet_id, perfometer::get_time());
+        }
+
+        stage = 1;
+        while (stage != 2)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            perfometer::log_event(quiet_id, perfometer::get_time());
+        }
+    });
+
+    while (stage != 1)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    perfometer::flush();
+
+    const report_contents reclaimed = read_report(file_name);
+
+    stage = 2;
+    quiet.join();
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    const report_contents report = read_report(file_name);
+
+    const size_t reclaimed_events = reclaimed.events.count(quiet_id) ? reclaimed.events.at(quiet_id) : 0;
+    const size_t events = report.events.count(quiet_id) ? report.events.at(quiet_id) : 0;
+
+    std::cout << "page reclaim wrote " << reclaimed_events << " events of quiet thread while it was alive, "
+              << events << " in total" << std::endl;
+
+    const bool passed = result == perfometer::result::ok && report.complete &&
+                        reclaimed_events == count && events == 2 * count;
+
+    return passed ? 0 : -1;
+}
+
+int test_arguments()
+{
+    auto result = perfometer::initialize("test_arguments.report");
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    const perfometer::string_id name_id = perfometer::register_string("batch");
+    const perfometer::string_id size_id = perfometer::register_string("size");
+
+    perfometer::argument args[perfometer::max_arguments + 1];
+    for (size_t i = 0; i <= perfometer::max_arguments; ++i)
+    {
+        args[i] = perfometer::argument::integer(size_id, i);
+    }
+
+    // records with all arguments are written, one more than max_arguments is rejected
+    perfometer::time t = perfometer::get_time();
+    bool passed = perfometer::log_work(name_id, t, t + 1, args, perfometer::max_arguments) == perfometer::result::ok &&
+                  perfometer::log_event(name_id, t, args, perfometer::max_arguments) == perfometer::result::ok &&
+                  perfometer::log_work(name_id, t, t + 1, args, perfometer::max_arguments + 1) == perfometer::result::invalid_arguments;
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return passed ? 0 : -1;
+}
+
+int test_write_string()
+{
+    auto result = perfometer::initialize("test_write_string.report", false);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    const perfometer::string_id paused_id = perfometer::write_string("paused", 6);
+
+    perfometer::resume();
+
+    // string not written names no record, record named by it is refused
+    bool passed = paused_id == perfometer::format::invalid_string_id &&
+                  perfometer::log_event(paused_id, perfometer::get_time()) == perfometer::result::invalid_arguments;
+
+    const perfometer::string_id running_id = perfometer::write_string("running", 7);
+    passed &= running_id == perfometer::format::dynamic_string_id &&
+              perfometer::log_event(running_id, perfometer::get_time()) == perfometer::result::ok;
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    return passed ? 0 : -1;
+}
+
+int test_flight_recorder_budget()
+{
+    perfometer::configuration config;
+    config.file_name = nullptr;
+    config.flight_recorder_pages = 16;
+
+    // budget of ring size leaves no page to log into
+    config.memory_budget = config.flight_recorder_pages * perfometer::records_cache_size;
+    bool passed = perfometer::initialize(config) == perfometer::result::invalid_arguments;
+
+    config.memory_budget = 4 * config.flight_recorder_pages * perfometer::records_cache_size;
+    passed &= perfometer::initialize(config) == perfometer::result::ok;
+
+    const perfometer::string_id name_id = perfometer::register_string("flight recorder budget");
+
+    // about 35 pages of events overflow ring, budget has them all however late logger runs
+    for (int i = 0; i < 30000; ++i)
+    {
+        passed &= perfometer::log_event(name_id, perfometer::get_time()) == perfometer::result::ok;
+    }
+
+    passed &= perfometer::shutdown() == perfometer::result::ok;
+
+    std::cout << "flight recorder budget test " << (passed ? "passed" : "failed") << std::endl;
+
+    return passed ? 0 : -1;
+}
+
+std::streamoff report_size(const char* file_name)
+{
+    std::ifstream report(file_name, std::ios::binary | std::ios::ate);
+    return report.tellg();
+}
+
+int test_sessions()
+{
+    const char* default_file_name = "test_sessions_default.report";
+    const char* detailed_file_name = "test_sessions_detailed.report";
+
+    auto result = perfometer::initialize(default_file_name);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    // detailed session runs alongside default one and writes own report
+    perfometer::session detailed;
+    bool passed = detailed.initialize(detailed_file_name) == perfometer::result::ok;
+
+    const perfometer::string_id name_id = perfometer::register_string("session");
+
+    std::thread thread([&]()
+    {
+        for (int i = 0; i < 10000; ++i)
+        {
+            detailed.log_event(name_id, perfometer::get_time());
+        }
+
+        detailed.flush_thread_cache();
+    });
+
+    for (int i = 0; i < 100; ++i)
+    {
+        perfometer::log_event(name_id, perfometer::get_time());
+    }
+
+    thread.join();
+
+    // sessions past max_sessions are refused
+    std::vector<std::unique_ptr<perfometer::session>> extra;
+    for (size_t i = 2; i <= perfometer::max_sessions; ++i)
+    {
+        perfometer::configuration config;
+        config.file_name = nullptr;
+        config.flight_recorder_pages = 1;
+
+        extra.emplace_back(new perfometer::session());
+
+        const perfometer::result expected = i < perfometer::max_sessions ? perfometer::result::ok : perfometer::result::overflow;
+        passed &= extra.back()->initialize(config) == expected;
+    }
+
+    extra.clear();
+
+    passed &= detailed.shutdown() == perfometer::result::ok;
+    passed &= detailed.log_event(name_id, perfometer::get_time()) == perfometer::result::not_running;
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    const std::streamoff default_size = report_size(default_file_name);
+    const std::streamoff detailed_size = report_size(detailed_file_name);
+
+    std::cout << "default session wrote " << default_size << " bytes, detailed session "
+              << detailed_size << " bytes" << std::endl;
+
+    // each event record takes at least 3 bytes
+    passed &= result == perfometer::result::ok && detailed_size > 10000 * 3 && default_size < detailed_size / 10;
+
+    return passed ? 0 : -1;
+}
+
+#if defined(__linux__)
+int test_crash_handler()
+{
+    const char* file_name = "test_crash_handler.report";
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        perfometer::configuration config;
+        config.file_name = file_name;
+        config.logger_max_latency_ms = 60000;
+        config.logger_wakeup_pages = 1000;
+        config.crash_handler = true;
+
+        perfometer::initialize(config);
+
+        // pages of both threads stay in progress or queued until process crashes
+        std::thread thread([]()
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                PERFOMETER_LOG_EVENT("worker");
+            }
+
+            perfometer::flush_thread_cache();
+        });
+
+        thread.join();
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            PERFOMETER_LOG_EVENT("main");
+        }
+
+        std::abort();
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    std::ifstream report(file_name, std::ios::binary | std::ios::ate);
+    const std::streamoff report_size = report.tellg();
+
+    std::cout << "crashed process wrote " << report_size << " bytes report" << std::endl;
+
+    // each event record takes at least 3 bytes
+    const bool passed = WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT && report_size > 2000 * 3;
+
+    return passed ? 0 : -1;
+}
+
+int test_fork(perfometer::fork_policy policy)
+{
+    perfometer::configuration config;
+    config.file_name = "test_fork.report";
+    config.on_fork = policy;
+
+    auto result = perfometer::initialize(config);
+    std::cout << "perfometer::initialize() returned " << result << std::endl;
+
+    // parent keeps logging from work threads while child is forked
+    start_work_threads();
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        PERFOMETER_LOG_THREAD_NAME("CHILD");
+
+        // child either logs into own report or does not log at all
+        const bool logging = policy == perfometer::fork_policy::new_report;
+        perfometer::result expected = logging ? perfometer::result::ok : perfometer::result::not_running;
+
+        bool passed = true;
+        for (int i = 0; i < 1000; ++i)
+        {
+            passed &= perfometer::log_event(perfometer::register_string("child"), perfometer::get_time()) == expected;
+        }
+
+        passed &= perfometer::shutdown() == (logging ? perfometer::result::ok : perfometer::result::not_initialized);
+
+        _exit(passed ? 0 : 1);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    wait_work_threads();
+
+    result = perfometer::shutdown();
+    std::cout << "perfometer::shutdown() returned " << result << std::endl;
+
+    const std::string child_report = std::string(config.file_name) + "." + std::to_string(pid);
+    const bool child_report_written = std::ifstream(child_report).good();
+    std::remove(child_report.c_str());
+
+    const bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0 && result == perfometer::result::ok &&
+                        child_report_written == (policy == perfometer::fork_policy::new_report);
+
+    return passed ? 0 : -1;
+}
+#endif
+
 int main(int argc, const char** argv)
 {
     test_late_start();
     test_early_stop();
     test_start_stop_repeat();
 
-    return 0;
+    int result = test_thread_churn();
+    result |= test_page_reclaim();
+
+    result |= test_arguments();
+    result |= test_write_string();
+    result |= test_flight_recorder_budget();
+    result |= test_sessions();
+
+#if defined(__linux__)
+    result |= test_crash_handler();
+    result |= test_fork(perfometer::fork_policy::stop);
+    result |= test_fork(perfometer::fork_policy::new_report);
+#endif
+
+    return result;
 }
@@ -0,0 +1,165 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "../src/string_table.h"
+#include <perfometer/format.h>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+void check_interning()
+{
+    perfometer::string_table table;
+    CHECK(table.size(), 0);
+    CHECK(table.find("work", 4), perfometer::format::invalid_string_id);
+
+    bool inserted = false;
+    perfometer::string_id work = table.intern("work", 4, inserted);
+    CHECK(inserted, true);
+    CHECK(work, perfometer::string_table::first_id);
+
+    perfometer::string_id wait = table.intern("wait", 4, inserted);
+    CHECK(inserted, true);
+    CHECK(wait, work + 1);
+
+    // same content from different buffer gets same id
+    std::string copy("work");
+    CHECK(table.intern(copy.c_str(), copy.size(), inserted), work);
+    CHECK(inserted, false);
+    CHECK(table.find("work", 4), work);
+
+    // prefix is different string
+    CHECK(table.intern("wor", 3, inserted), wait + 1);
+    CHECK(inserted, true);
+
+    CHECK(table.intern("", 0, inserted), wait + 2);
+    CHECK(table.intern("", 0, inserted), wait + 2);
+    CHECK(inserted, false);
+
+    CHECK(table.size(), 4);
+
+    std::vector<std::string> strings;
+    table.for_each([&strings](perfometer::string_id, const std::string& string)
+    {
+        strings.push_back(string);
+    });
+
+    CHECK(strings.size(), 4);
+    CHECK(strings[0], "work");
+    CHECK(strings[1], "wait");
+}
+
+void check_concurrent_interning()
+{
+    constexpr int num_threads = 8;
+    constexpr int num_strings = 10000;
+
+    perfometer::string_table table;
+
+    std::atomic<int> failures(0);
+    std::atomic<int> insertions(0);
+    std::vector<std::vector<perfometer::string_id>> ids(num_threads);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (int i = 0; i < num_strings; ++i)
+            {
+                const std::string string = "string_" + std::to_string(i);
+
+                bool inserted = false;
+                perfometer::string_id str_id = table.intern(string.c_str(), string.size(), inserted);
+                if (str_id == perfometer::format::invalid_string_id)
+                {
+                    failures++;
+                }
+
+                if (inserted)
+                {
+                    insertions++;
+                }
+
+                ids[t].push_back(str_id);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(failures, 0);
+    CHECK(insertions, num_strings);
+    CHECK(table.size(), num_strings);
+
+    for (int t = 1; t < num_threads; ++t)
+    {
+        CHECK(ids[t] == ids[0], true);
+    }
+}
+
+void check_static_string_collision()
+{
+    const perfometer::string_id hash = perfometer::format::static_string_id_base | 0x1234;
+
+    // registered nodes stay in list for the rest of the process
+    static perfometer::static_string_node first = { hash, "first", 5, nullptr };
+    static perfometer::static_string_node second = { hash, "second", 6, nullptr };
+    static perfometer::static_string_node first_again = { hash, "first", 5, nullptr };
+    static perfometer::static_string_node second_again = { hash, "second", 6, nullptr };
+
+    perfometer::register_static_string(first);
+    perfometer::register_static_string(second);
+    perfometer::register_static_string(first_again);
+    perfometer::register_static_string(second_again);
+
+    // other name hashing to the same id gets own id, same name keeps sharing it
+    CHECK(first.id, hash);
+    CHECK(second.id != hash, true);
+    CHECK(second.id >= perfometer::format::static_string_id_base, true);
+    CHECK(second.id != perfometer::format::invalid_string_id, true);
+    CHECK(first_again.id, hash);
+    CHECK(second_again.id, second.id);
+}
+
+int main(int argc, const char** argv)
+{
+    check_interning();
+    check_concurrent_interning();
+    check_static_string_collision();
+
+    return result;
+}
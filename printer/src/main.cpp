@@ -104,6 +104,81 @@ public:
                   << std::endl;
     }
 
+    void handle_suppressed(perfometer::string_id string_id, perf_thread_id thread_id, size_t count) override
+    {
+        std::cout << "Suppressed " << string_id << ":" << string_by_id(string_id)
+                  << " on " << thread_id << ":" << thread_name_by_id(thread_id)
+                  << " count " << count
+                  << std::endl;
+    }
+
+    void handle_counter(perfometer::string_id string_id, perf_thread_id thread_id, double time, int64_t value) override
+    {
+        std::cout << "Counter " << string_id << ":" << string_by_id(string_id)
+                  << " on " << thread_id << ":" << thread_name_by_id(thread_id)
+                  << " value " << value
+                  << " at " << time_formatter(time, m_options.tfmt)
+                  << std::endl;
+    }
+
+    void handle_gauge(perfometer::string_id string_id, perf_thread_id thread_id, double time, double value) override
+    {
+        std::cout << "Gauge " << string_id << ":" << string_by_id(string_id)
+                  << " on " << thread_id << ":" << thread_name_by_id(thread_id)
+                  << " value " << value
+                  << " at " << time_formatter(time, m_options.tfmt)
+                  << std::endl;
+    }
+
+    void handle_flow_begin(perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id) override
+    {
+        print_flow("begin", string_id, thread_id, time, flow_id);
+    }
+
+    void handle_flow_step(perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id) override
+    {
+        print_flow("step", string_id, thread_id, time, flow_id);
+    }
+
+    void handle_flow_end(perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id) override
+    {
+        print_flow("end", string_id, thread_id, time, flow_id);
+    }
+
+    void handle_arguments(perfometer::string_id string_id, perf_thread_id thread_id, argument_span arguments) override
+    {
+        std::cout << "Arguments of " << string_id << ":" << string_by_id(string_id);
+
+        for (const record_argument& arg : arguments)
+        {
+            std::cout << " " << string_by_id(arg.name) << "=";
+
+            switch (arg.type)
+            {
+                case perfometer::argument_type::integer:
+                    std::cout << arg.value.integer;
+                    break;
+                case perfometer::argument_type::real:
+                    std::cout << arg.value.real;
+                    break;
+                case perfometer::argument_type::string:
+                    std::cout << string_by_id(arg.value.string);
+                    break;
+            }
+        }
+
+        std::cout << std::endl;
+    }
+
+private:
+    void print_flow(const char* phase, perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id)
+    {
+        std::cout << "Flow " << flow_id << " " << phase << " " << string_id << ":" << string_by_id(string_id)
+                  << " on " << thread_id << ":" << thread_name_by_id(thread_id)
+                  << " at " << time_formatter(time, m_options.tfmt)
+                  << std::endl;
+    }
+
 private:
     options m_options;
 };
@@ -130,6 +205,16 @@ int process(const char* filename, options opts)
             auto count = stat.second;
             std::cout << string_id << " " << reader.string_by_id(string_id) << " " << stat.second << std::endl;
         }
+
+        if (!stats.suppressed.empty())
+        {
+            std::cout << "Suppressed " << stats.suppressed.size() << std::endl;
+
+            for (auto&& stat : stats.suppressed)
+            {
+                std::cout << stat.first << " " << reader.string_by_id(stat.first) << " " << stat.second << std::endl;
+            }
+        }
     }
     else 
     {
@@ -22,6 +22,7 @@ SOFTWARE. */
 
 #include <perfometer/perfometer.h>
 #include <utils/time.h>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +34,17 @@ namespace perfometer
         using perf_thread_id = int64_t; // holding at least 8 bytes
         using perf_time = uint64_t;     // holding at least 8 bytes
         using perf_string_id = perfometer::string_id;
+        using record_argument = perfometer::argument;
+
+        // arguments of single record, valid only during handle_arguments call
+        struct argument_span
+        {
+            const record_argument* begin() const { return data; }
+            const record_argument* end() const { return data + size; }
+
+            const record_argument* data;
+            size_t size;
+        };
 
         class report_reader
         {
@@ -43,6 +55,7 @@ namespace perfometer
                 size_t num_pages            = 0;
                 size_t num_blocks           = 0;
                 std::vector<std::pair<perfometer::string_id, size_t>> occurences;
+                std::vector<std::pair<perfometer::string_id, size_t>> suppressed; // records dropped by sampling or rate limit
             };
 
             report_reader();
@@ -50,6 +63,10 @@ namespace perfometer
 
             perfometer::result process(const char* filename);
 
+            // processes report bytes as they arrive, e.g. from perfometer::socket_sink, whole records
+            // are processed right away and the rest waits for next call, 5.1.0 reports and newer
+            perfometer::result process_data(const void* data, size_t size);
+
             const statistics& stats() const { return m_statistics; }
 
             const std::string& string_by_id(perf_string_id id) { return m_strings[id]; }
@@ -66,10 +83,26 @@ namespace perfometer
             virtual void handle_work(perfometer::string_id string_id, perf_thread_id thread_id, double time_start, double time_end) {}
             virtual void handle_wait(perfometer::string_id string_id, perf_thread_id thread_id, double time_start, double time_end) {}
             virtual void handle_event(perfometer::string_id string_id, perf_thread_id thread_id, double time) {}
+            virtual void handle_suppressed(perfometer::string_id string_id, perf_thread_id thread_id, size_t count) {}
+            virtual void handle_counter(perfometer::string_id string_id, perf_thread_id thread_id, double time, int64_t value) {}
+            virtual void handle_gauge(perfometer::string_id string_id, perf_thread_id thread_id, double time, double value) {}
+            virtual void handle_flow_begin(perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id) {}
+            virtual void handle_flow_step(perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id) {}
+            virtual void handle_flow_end(perfometer::string_id string_id, perf_thread_id thread_id, double time, uint64_t flow_id) {}
+            // follows handle_work, handle_wait or handle_event of the record arguments belong to
+            virtual void handle_arguments(perfometer::string_id string_id, perf_thread_id thread_id, argument_span arguments) {}
 
         private:
+            struct stream_state;
+
             double convert_time(perf_time time);
 
+            template<typename report_stream>
+            perfometer::result process_header(report_stream& report);
+
+            template<typename report_stream>
+            perfometer::result process_records(report_stream& report, size_t report_size, bool report_progress);
+
         private:
             perf_time m_init_time = 0;
             perf_time m_clock_frequency = 0;
@@ -77,7 +110,11 @@ namespace perfometer
             std::unordered_map<perf_string_id, std::string>         m_strings;
             std::unordered_map<perf_thread_id, perf_string_id>      m_threads;
             std::unordered_map<perf_string_id, size_t>              m_blocks_occurences;
+            std::unordered_map<perf_string_id, size_t>              m_blocks_suppressed;
+            std::unordered_map<perf_thread_id, std::vector<std::string>> m_dynamic_strings; // by transient id
             statistics m_statistics;
+
+            std::unique_ptr<stream_state> m_stream;
         };
     }
 }
\ No newline at end of file
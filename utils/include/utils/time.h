@@ -20,7 +20,7 @@ SOFTWARE. */
 
 #pragma once
 
-#include <perfometer/time.h>
+#include <perfometer/config.h>
 #include <string>
 #include <ostream>
 
@@ -19,11 +19,14 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE. */
 
 #include <utils/report_reader.h>
+#include <perfometer/compression.h>
 #include <perfometer/format.h>
 #include <cstddef>
 #include <cstring>
 #include <algorithm>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <vector>
 
@@ -33,6 +36,9 @@ SOFTWARE. */
 namespace perfometer {
 namespace utils {
 
+// bound of dynamic string transient ids accepted per thread, writer cache is much smaller
+constexpr uint64_t max_transient_id = 65536;
+
 template<typename stream>
 class binary_stream_reader : public stream
 {
@@ -67,35 +73,151 @@ public:
         return *this;
     }
 
+    binary_stream_reader& operator >> (double& value)
+    {
+        stream::read(reinterpret_cast<char*>(&value), sizeof(value));
+        return *this;
+    }
+
+    binary_stream_reader& operator >> (uint16_t& value)
+    {
+        stream::read(reinterpret_cast<char*>(&value), sizeof(value));
+        return *this;
+    }
+
     binary_stream_reader& operator >> (perf_string_id& id)
     {
-        stream::read(reinterpret_cast<char*>(&id), sizeof(perf_string_id));
+        if (m_string_id_varint)
+        {
+            uint64_t value = 0;
+            read_varint(value);
+
+            id = static_cast<perf_string_id>(value);
+        }
+        else
+        {
+            uint16_t value = 0;
+            *this >> value;
+
+            // 16 bit invalid id of older versions
+            id = value == std::numeric_limits<uint16_t>::max() ? perfometer::format::invalid_string_id : value;
+        }
 
         return *this;
     }
 
-    binary_stream_reader& read_string(char* buffer, size_t buffer_size)
+    binary_stream_reader& read_varint(uint64_t& value)
     {
-        uint8_t name_length = 0;
-        *this >> name_length;
+        value = 0;
+
+        for (size_t i = 0; i < perfometer::format::max_varint_size; ++i)
+        {
+            uint8_t byte = 0;
+            *this >> byte;
+
+            value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+
+        return *this;
+    }
 
-        size_t length = std::min(buffer_size - 1, static_cast<size_t>(name_length));
+    // reads zigzag varint delta and applies it to base
+    binary_stream_reader& read_time_delta(perf_time& time, perf_time base)
+    {
+        uint64_t delta = 0;
+        read_varint(delta);
 
-        stream::read(buffer, length);
-        buffer[length] = 0;
+        time = base + static_cast<perf_time>(perfometer::format::zigzag_decode(delta));
+
+        return *this;
+    }
+
+    binary_stream_reader& read_string(std::string& string)
+    {
+        uint64_t length = 0;
+
+        if (m_string_length_varint)
+        {
+            read_varint(length);
+        }
+        else
+        {
+            uint8_t byte = 0;
+            *this >> byte;
+
+            length = byte;
+        }
+
+        string.resize(std::min<uint64_t>(length, perfometer::max_string_length));
+        stream::read(&string[0], string.size());
+
+        // skipping truncated tail of malformed record
+        if (length > string.size())
+        {
+            stream::ignore(length - string.size());
+        }
 
         return *this;
     }
 
     void set_thread_id_size(size_t size) { m_thread_id_size = size; }
     void set_time_size(size_t size) { m_time_size = size; }
+    void set_string_id_varint(bool varint) { m_string_id_varint = varint; }
+    void set_string_length_varint(bool varint) { m_string_length_varint = varint; }
 
 private:
     size_t m_thread_id_size = 0;
     size_t m_time_size = 0;
+    bool m_string_id_varint = true;
+    bool m_string_length_varint = true;
+};
+
+// format of report being read and reading position within page,
+// kept between process_data calls of incrementally read report
+struct report_reader::stream_state
+{
+    bool header_read = false;
+
+    // up until 2.x.x every work, wait and event record carried thread id, since 3.0.0 page does
+    bool thread_id_per_record = false;
+
+    // since 4.0.0 record times are varint deltas to previous record time in page
+    bool time_deltas = true;
+
+    // since 5.0.0 string ids are 32 bit varints, 16 bit before
+    bool string_id_varint = true;
+
+    // since 5.1.0 string lengths are varints, 8 bit before
+    bool string_length_varint = true;
+
+    perf_time duration = 0;
+    perf_thread_id main_thread_id = 0;
+    uint8_t thread_id_size = 0;
+    uint8_t time_size = 0;
+
+    std::streampos page_end = -1;
+    bool page_incomplete = false;
+    perf_thread_id page_thread_id = 0;
+    perf_time page_last_time = 0;
+    perf_string_id page_last_record = perfometer::format::invalid_string_id;
+
+    std::string string;
+    std::vector<record_argument> arguments;
+
+    std::vector<uint8_t> compressed_page;
+    std::vector<uint8_t> page;
+
+    // received bytes not yet forming whole top level record
+    std::vector<uint8_t> pending;
 };
 
 report_reader::report_reader()
+    : m_stream(std::make_unique<stream_state>())
 {
 }
 
@@ -108,29 +230,15 @@ double report_reader::convert_time(perf_time time)
     return static_cast<double>(time - m_init_time) / m_clock_frequency;
 }
 
-perfometer::result report_reader::process(const char* filename)
+template<typename report_stream>
+perfometer::result report_reader::process_header(report_stream& report)
 {
-    binary_stream_reader<std::ifstream> report_file(filename, std::ios::binary | std::ios::ate);
-
-    if (!report_file)
-    {
-        LOG_ERROR( "Cannot open file " << filename );
-        return perfometer::result::file_not_found;
-    }
-
-    LOG( "Opening report file " << filename );
-
-    const size_t report_size = report_file.tellg();
-    report_file.seekg(0);
-    size_t progress = 0;
-
     char header[16];
-    report_file.read(header, 11);
+    report.read(header, 11);
     header[11] = 0;
 
-    if (report_file.fail() || std::strncmp(header, perfometer::format::header, 11))
+    if (report.fail() || std::strncmp(header, perfometer::format::header, 11))
     {
-        LOG_ERROR( "Wrong file format " << filename );
         return perfometer::result::wrong_format;
     }
 
@@ -138,9 +246,9 @@ perfometer::result report_reader::process(const char* filename)
     uint8_t minor_version = 0;
     uint8_t patch_version = 0;
 
-    report_file >> major_version
-                >> minor_version
-                >> patch_version;
+    report >> major_version
+           >> minor_version
+           >> patch_version;
 
     LOG( "File version "
          << int(major_version) << "."
@@ -159,38 +267,192 @@ perfometer::result report_reader::process(const char* filename)
         return perfometer::result::newer_format;
     }
 
-    constexpr size_t buffer_size = 1024;
-    char buffer[buffer_size];
+    stream_state& state = *m_stream;
 
-    perf_time duration = 0;
-    perf_thread_id main_thread_id = 0;
+    state.header_read = true;
+    state.thread_id_per_record = major_version < 3;
+    state.time_deltas = major_version >= 4;
+    state.string_id_varint = major_version >= 5;
+    state.string_length_varint = report_version >= (5 << 16 | 1 << 8);
 
-    std::streampos page_end = -1;
-    perfometer::format::record_type record_type;
+    return perfometer::result::ok;
+}
+
+perfometer::result report_reader::process(const char* filename)
+{
+    binary_stream_reader<std::ifstream> report_file(filename, std::ios::binary | std::ios::ate);
+
+    if (!report_file)
+    {
+        LOG_ERROR( "Cannot open file " << filename );
+        return perfometer::result::file_not_found;
+    }
+
+    LOG( "Opening report file " << filename );
+
+    const size_t report_size = report_file.tellg();
+    report_file.seekg(0);
 
-    while ((report_file >> record_type) && !report_file.eof())
+    perfometer::result result = process_header(report_file);
+    if (result == perfometer::result::wrong_format)
     {
-        if (report_file.fail())
+        LOG_ERROR( "Wrong file format " << filename );
+    }
+
+    if (result != perfometer::result::ok)
+    {
+        return result;
+    }
+
+    result = process_records(report_file, report_size, true);
+    if (result != perfometer::result::ok)
+    {
+        return result;
+    }
+
+    m_statistics.duration = static_cast<double>(m_stream->duration) / m_clock_frequency;
+
+    auto sorted_by_count = [](const std::unordered_map<perf_string_id, size_t>& counts,
+                              std::vector<std::pair<perfometer::string_id, size_t>>& sorted)
+    {
+        sorted.reserve(counts.size());
+        std::copy(counts.begin(), counts.end(), std::back_inserter(sorted));
+        std::sort(sorted.begin(), sorted.end(), [](const auto& left, const auto& right)
         {
-            LOG_ERROR( "Error reading file " << filename )
-            return perfometer::result::io_error;
+            return left.second < right.second;
+        });
+    };
+
+    sorted_by_count(m_blocks_occurences, m_statistics.occurences);
+    sorted_by_count(m_blocks_suppressed, m_statistics.suppressed);
+
+    return perfometer::result::ok;
+}
+
+// report stream is cut into whole top level records, each processed as small report of its own
+perfometer::result report_reader::process_data(const void* data, size_t size)
+{
+    stream_state& state = *m_stream;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    state.pending.insert(state.pending.end(), bytes, bytes + size);
+
+    size_t offset = 0;
+
+    if (!state.header_read)
+    {
+        if (state.pending.size() < perfometer::format::header_size)
+        {
+            return perfometer::result::ok;
         }
 
-        size_t current_progress = report_file.tellg() * 100 / report_size;
-        if (current_progress > progress)
+        binary_stream_reader<std::istringstream> header(
+            std::string(reinterpret_cast<const char*>(state.pending.data()), perfometer::format::header_size),
+            std::ios::binary);
+
+        perfometer::result result = process_header(header);
+        if (result == perfometer::result::ok && !state.string_length_varint)
         {
-            progress = current_progress;
-            handle_loading_progress(progress);
+            LOG_ERROR( "Report stream older than 5.1.0 is not supported" );
+            result = perfometer::result::wrong_format;
+        }
+        else if (result == perfometer::result::wrong_format)
+        {
+            LOG_ERROR( "Wrong report stream format" );
         }
 
-        m_statistics.num_blocks++;
+        if (result != perfometer::result::ok)
+        {
+            return result;
+        }
+
+        offset = perfometer::format::header_size;
+    }
+
+    perfometer::result result = perfometer::result::ok;
+
+    while (offset < state.pending.size())
+    {
+        const uint8_t* record = state.pending.data() + offset;
+        const size_t available = state.pending.size() - offset;
+
+        if (!perfometer::format::top_level_record(static_cast<perfometer::format::record_type>(record[0])))
+        {
+            LOG_ERROR( "ERROR: Unexpected record type in report stream " << int(record[0]) );
+            result = perfometer::result::wrong_format;
+            break;
+        }
+
+        const size_t record_size = perfometer::format::top_level_record_size(record, available, state.thread_id_size);
+        if (record_size == 0)
+        {
+            break;
+        }
+
+        binary_stream_reader<std::istringstream> record_stream(
+            std::string(reinterpret_cast<const char*>(record), record_size), std::ios::binary);
+
+        offset += record_size;
+
+        result = process_records(record_stream, record_size, false);
+        if (result != perfometer::result::ok)
+        {
+            break;
+        }
+    }
+
+    state.pending.erase(state.pending.begin(), state.pending.begin() + offset);
+
+    m_statistics.duration = static_cast<double>(state.duration) / m_clock_frequency;
+
+    return result;
+}
+
+template<typename report_stream>
+perfometer::result report_reader::process_records(report_stream& report, size_t report_size, bool report_progress)
+{
+    stream_state& state = *m_stream;
+
+    const bool thread_id_per_record = state.thread_id_per_record;
+    const bool time_deltas = state.time_deltas;
+    const bool string_id_varint = state.string_id_varint;
+    const bool string_length_varint = state.string_length_varint;
+
+    report.set_thread_id_size(state.thread_id_size);
+    report.set_time_size(state.time_size);
+    report.set_string_id_varint(string_id_varint);
+    report.set_string_length_varint(string_length_varint);
+
+    std::string& string = state.string;
+
+    perf_time& duration = state.duration;
+    perf_thread_id& main_thread_id = state.main_thread_id;
+    uint8_t& thread_id_size = state.thread_id_size;
+    uint8_t& time_size = state.time_size;
+
+    std::streampos& page_end = state.page_end;
+    bool& page_incomplete = state.page_incomplete;
+    perf_thread_id& page_thread_id = state.page_thread_id;
+    perf_time& page_last_time = state.page_last_time;
+    perf_string_id& page_last_record = state.page_last_record;
+    perfometer::format::record_type record_type;
 
+    std::vector<record_argument>& arguments = state.arguments;
+
+    std::vector<uint8_t>& compressed_page = state.compressed_page;
+    std::vector<uint8_t>& page = state.page;
+
+    size_t progress = 0;
+
+    // processes single record read either from report file or from decompressed page,
+    // returns wrong_format for unknown record type leaving the stream right after the type
+    auto process_record = [&](auto& stream, perfometer::format::record_type record_type)
+    {
         switch (record_type)
         {
             case perfometer::format::record_type::clock_configuration:
             {
-                uint8_t time_size = 0;
-                report_file >> time_size;
+                stream >> time_size;
 
                 if (time_size > 8)
                 {
@@ -198,10 +460,10 @@ perfometer::result report_reader::process(const char* filename)
                     return perfometer::result::invalid_arguments;
                 }
 
-                report_file.set_time_size(time_size);
+                stream.set_time_size(time_size);
 
-                report_file >> m_clock_frequency
-                            >> m_init_time;
+                stream >> m_clock_frequency
+                       >> m_init_time;
 
                 handle_clock_configuration(time_size, m_clock_frequency, m_init_time);
 
@@ -209,8 +471,7 @@ perfometer::result report_reader::process(const char* filename)
             }
             case perfometer::format::record_type::thread_info:
             {
-                uint8_t thread_id_size = 0;
-                report_file >> thread_id_size;
+                stream >> thread_id_size;
 
                 if (thread_id_size > 8)
                 {
@@ -218,9 +479,9 @@ perfometer::result report_reader::process(const char* filename)
                     return perfometer::result::invalid_arguments;
                 }
 
-                report_file.set_thread_id_size(thread_id_size);
+                stream.set_thread_id_size(thread_id_size);
 
-                report_file >> main_thread_id;
+                stream >> main_thread_id;
 
                 handle_thread_info(thread_id_size, main_thread_id);
 
@@ -229,13 +490,25 @@ perfometer::result report_reader::process(const char* filename)
             case perfometer::format::record_type::page:
             {
                 uint16_t page_size = 0;
-                report_file >> page_size;
+                stream >> page_size;
 
-                page_end = report_file.tellg() + std::streampos(page_size);
+                // report of crashed or killed process may end inside the last page
+                if (!stream || stream.tellg() + std::streampos(page_size) > std::streampos(report_size))
+                {
+                    page_incomplete = true;
+                    break;
+                }
+
+                page_end = stream.tellg() + std::streampos(page_size);
 
-                perf_thread_id page_thread_id = 0;
-                report_file >> page_thread_id;
+                stream >> page_thread_id;
 
+                if (time_deltas)
+                {
+                    stream >> page_last_time;
+                }
+
+                page_last_record = perfometer::format::invalid_string_id;
                 m_statistics.num_pages++;
 
                 LOG( "reading page " << page_size << " bytes with thread id " << page_thread_id );
@@ -245,6 +518,7 @@ perfometer::result report_reader::process(const char* filename)
             case perfometer::format::record_type::page_end:
             {
                 page_end = -1;
+                page_thread_id = 0;
 
                 LOG( "page ended" );
 
@@ -253,11 +527,42 @@ perfometer::result report_reader::process(const char* filename)
             case perfometer::format::record_type::string:
             {
                 perf_string_id id = 0;
-                report_file >> id;
+                stream >> id;
 
-                report_file.read_string(buffer, buffer_size);
+                stream.read_string(string);
 
-                handle_string(id, m_strings[id] = buffer);
+                handle_string(id, m_strings[id] = string);
+
+                break;
+            }
+            case perfometer::format::record_type::dynamic_string:
+            case perfometer::format::record_type::dynamic_string_ref:
+            {
+                uint64_t transient_id = 0;
+                stream.read_varint(transient_id);
+
+                if (transient_id >= max_transient_id)
+                {
+                    LOG_ERROR( "ERROR: Dynamic string transient id too large " << transient_id );
+                    return perfometer::result::wrong_format;
+                }
+
+                std::vector<std::string>& strings = m_dynamic_strings[page_thread_id];
+                if (transient_id >= strings.size())
+                {
+                    strings.resize(transient_id + 1);
+                }
+
+                if (record_type == perfometer::format::record_type::dynamic_string)
+                {
+                    stream.read_string(strings[transient_id]);
+                }
+
+                // name of next record with dynamic string id
+                std::string& dynamic_string = m_strings[perfometer::format::dynamic_string_id];
+                dynamic_string = strings[transient_id];
+
+                handle_string(perfometer::format::dynamic_string_id, dynamic_string);
 
                 break;
             }
@@ -266,8 +571,8 @@ perfometer::result report_reader::process(const char* filename)
                 perf_thread_id thread_id = 0;
                 perf_string_id string_id = 0;
 
-                report_file >> thread_id
-                            >> string_id;
+                stream >> thread_id
+                       >> string_id;
 
                 m_threads[thread_id] = string_id;
 
@@ -279,18 +584,38 @@ perfometer::result report_reader::process(const char* filename)
             case perfometer::format::record_type::wait:
             {
                 perf_string_id string_id = 0;
-                perf_thread_id thread_id = 0;
+                perf_thread_id thread_id = page_thread_id;
                 perf_time time_start = 0;
                 perf_time time_end = 0;
 
-                report_file >> string_id
-                            >> time_start
-                            >> time_end
-                            >> thread_id;
+                stream >> string_id;
+
+                if (time_deltas)
+                {
+                    uint64_t duration = 0;
+
+                    stream.read_time_delta(time_start, page_last_time)
+                          .read_varint(duration);
+
+                    time_end = time_start + duration;
+                    page_last_time = time_start;
+                }
+                else
+                {
+                    stream >> time_start
+                           >> time_end;
+                }
+
+                if (thread_id_per_record)
+                {
+                    stream >> thread_id;
+                }
 
                 m_blocks_occurences.emplace(string_id, 0).first->second++;
                 duration = std::max<perf_time>(duration, time_end - m_init_time);
 
+                page_last_record = string_id;
+
                 if (record_type == perfometer::format::record_type::work)
                 {
                     handle_work(string_id, thread_id, convert_time(time_start), convert_time(time_end));
@@ -305,47 +630,265 @@ perfometer::result report_reader::process(const char* filename)
             case perfometer::format::record_type::event:
             {
                 perf_string_id string_id = 0;
-                perf_thread_id thread_id = 0;
+                perf_thread_id thread_id = page_thread_id;
                 perf_time t = 0;
 
-                report_file >> string_id
-                            >> t
-                            >> thread_id;
+                stream >> string_id;
+
+                if (time_deltas)
+                {
+                    stream.read_time_delta(t, page_last_time);
+                    page_last_time = t;
+                }
+                else
+                {
+                    stream >> t;
+                }
+
+                if (thread_id_per_record)
+                {
+                    stream >> thread_id;
+                }
 
                 m_blocks_occurences.emplace(string_id, 0).first->second++;
                 duration = std::max<perf_time>(duration, t - m_init_time);
 
+                page_last_record = string_id;
+
                 handle_event(string_id, thread_id, convert_time(t));
 
                 break;
             }
-            default:
+            case perfometer::format::record_type::counter:
+            case perfometer::format::record_type::gauge:
             {
-                LOG_ERROR( "ERROR: Unknown record type " << int(record_type) );
+                perf_string_id string_id = 0;
+                perf_time t = 0;
 
-                if (page_end > report_file.tellg() && page_end < report_size)
+                stream >> string_id;
+                stream.read_time_delta(t, page_last_time);
+                page_last_time = t;
+
+                m_blocks_occurences.emplace(string_id, 0).first->second++;
+                duration = std::max<perf_time>(duration, t - m_init_time);
+
+                if (record_type == perfometer::format::record_type::counter)
                 {
-                    report_file.seekg(page_end);
+                    uint64_t value = 0;
+                    stream.read_varint(value);
+
+                    handle_counter(string_id, page_thread_id, convert_time(t), perfometer::format::zigzag_decode(value));
+                }
+                else
+                {
+                    double value = 0.0;
+                    stream >> value;
+
+                    handle_gauge(string_id, page_thread_id, convert_time(t), value);
+                }
+
+                break;
+            }
+            case perfometer::format::record_type::flow_begin:
+            case perfometer::format::record_type::flow_step:
+            case perfometer::format::record_type::flow_end:
+            {
+                perf_string_id string_id = 0;
+                perf_time t = 0;
+                uint64_t flow_id = 0;
+
+                stream >> string_id;
+                stream.read_time_delta(t, page_last_time)
+                      .read_varint(flow_id);
+                page_last_time = t;
+
+                m_blocks_occurences.emplace(string_id, 0).first->second++;
+                duration = std::max<perf_time>(duration, t - m_init_time);
 
-                    LOG_ERROR( "Jumping to end of page at " << page_end );
+                if (record_type == perfometer::format::record_type::flow_begin)
+                {
+                    handle_flow_begin(string_id, page_thread_id, convert_time(t), flow_id);
+                }
+                else if (record_type == perfometer::format::record_type::flow_step)
+                {
+                    handle_flow_step(string_id, page_thread_id, convert_time(t), flow_id);
                 }
                 else
                 {
-                    LOG_ERROR( "No next page" )
-                    return perfometer::result::io_error;
+                    handle_flow_end(string_id, page_thread_id, convert_time(t), flow_id);
                 }
+
+                break;
+            }
+            case perfometer::format::record_type::arguments:
+            {
+                uint8_t count = 0;
+                stream >> count;
+
+                arguments.resize(count);
+                for (record_argument& arg : arguments)
+                {
+                    uint8_t type = 0;
+                    stream >> type
+                           >> arg.name;
+
+                    arg.type = static_cast<perfometer::argument_type>(type);
+                    switch (arg.type)
+                    {
+                        case perfometer::argument_type::integer:
+                        {
+                            uint64_t value = 0;
+                            stream.read_varint(value);
+                            arg.value.integer = perfometer::format::zigzag_decode(value);
+                            break;
+                        }
+                        case perfometer::argument_type::real:
+                            stream >> arg.value.real;
+                            break;
+                        case perfometer::argument_type::string:
+                            stream >> arg.value.string;
+                            break;
+                        default:
+                            LOG_ERROR( "ERROR: Unknown argument type " << int(type) );
+                            return perfometer::result::wrong_format;
+                    }
+                }
+
+                handle_arguments(page_last_record, page_thread_id, argument_span{arguments.data(), arguments.size()});
+
+                break;
+            }
+            case perfometer::format::record_type::suppressed:
+            {
+                perf_string_id string_id = 0;
+                uint64_t count = 0;
+
+                stream >> string_id;
+                stream.read_varint(count);
+
+                m_blocks_suppressed.emplace(string_id, 0).first->second += count;
+
+                handle_suppressed(string_id, page_thread_id, count);
+
+                break;
+            }
+            default:
+            {
+                LOG_ERROR( "ERROR: Unknown record type " << int(record_type) );
+                return perfometer::result::wrong_format;
             }
         }
-    }
 
-    m_statistics.duration = static_cast<double>(duration) / m_clock_frequency;
+        return perfometer::result::ok;
+    };
+
+    // decompresses page into memory and processes its records, page_end follows in report file
+    auto process_compressed_page = [&]()
+    {
+        uint16_t compressed_size = 0;
+        uint16_t page_size = 0;
+        report >> compressed_size
+                    >> page_size;
+
+        if (!report || report.tellg() + std::streampos(compressed_size) > std::streampos(report_size))
+        {
+            page_incomplete = true;
+            return perfometer::result::ok;
+        }
+
+        page_end = report.tellg() + std::streampos(compressed_size);
+
+        compressed_page.resize(compressed_size);
+        page.resize(page_size);
+
+        report.read(reinterpret_cast<char*>(compressed_page.data()), compressed_size);
+
+        if (report.fail() ||
+            perfometer::compression::decompress(compressed_page.data(), compressed_size,
+                                                page.data(), page_size) != page_size)
+        {
+            LOG_ERROR( "ERROR: Cannot decompress page of " << compressed_size << " bytes" );
+            return perfometer::result::wrong_format;
+        }
+
+        binary_stream_reader<std::istringstream> page_stream(
+            std::string(reinterpret_cast<const char*>(page.data()), page.size()), std::ios::binary);
+
+        page_stream.set_thread_id_size(thread_id_size);
+        page_stream.set_time_size(time_size);
+        page_stream.set_string_id_varint(string_id_varint);
+        page_stream.set_string_length_varint(string_length_varint);
+
+        page_stream >> page_thread_id
+                    >> page_last_time;
+
+        page_last_record = perfometer::format::invalid_string_id;
+        m_statistics.num_pages++;
+
+        LOG( "reading compressed page " << compressed_size << "/" << page_size
+             << " bytes with thread id " << page_thread_id );
 
-    m_statistics.occurences.reserve(m_blocks_occurences.size());
-    std::copy(m_blocks_occurences.begin(), m_blocks_occurences.end(), std::back_inserter(m_statistics.occurences));
-    std::sort(m_statistics.occurences.begin(), m_statistics.occurences.end(), [](const auto& left, const auto& right)
+        perfometer::format::record_type page_record_type;
+        while ((page_stream >> page_record_type) && !page_stream.eof())
+        {
+            m_statistics.num_blocks++;
+
+            perfometer::result result = process_record(page_stream, page_record_type);
+            if (result != perfometer::result::ok)
+            {
+                return result;
+            }
+        }
+
+        return perfometer::result::ok;
+    };
+
+    while ((report >> record_type) && !report.eof())
     {
-        return left.second < right.second;
-    });
+        if (report.fail())
+        {
+            LOG_ERROR( "Error reading report" )
+            return perfometer::result::io_error;
+        }
+
+        size_t current_progress = report.tellg() * 100 / report_size;
+        if (report_progress && current_progress > progress)
+        {
+            progress = current_progress;
+            handle_loading_progress(progress);
+        }
+
+        m_statistics.num_blocks++;
+
+        perfometer::result result = record_type == perfometer::format::record_type::page_compressed
+                                  ? process_compressed_page()
+                                  : process_record(report, record_type);
+
+        if (page_incomplete)
+        {
+            LOG_ERROR( "Report ends inside page, skipping incomplete page" );
+            break;
+        }
+
+        if (result == perfometer::result::wrong_format)
+        {
+            if (page_end > report.tellg() && page_end < std::streampos(report_size))
+            {
+                report.seekg(page_end);
+
+                LOG_ERROR( "Jumping to end of page at " << page_end );
+            }
+            else if (page_end != report.tellg())
+            {
+                LOG_ERROR( "No next page" )
+                return perfometer::result::io_error;
+            }
+        }
+        else if (result != perfometer::result::ok)
+        {
+            return result;
+        }
+    }
 
     return perfometer::result::ok;
 }
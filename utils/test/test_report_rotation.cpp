@@ -0,0 +1,253 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <utils/report_reader.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+class segment_reader : public perfometer::utils::report_reader
+{
+public:
+    size_t works = 0;
+    size_t named_works = 0;
+    size_t dynamic_works = 0;
+    size_t unnamed_works = 0;
+    size_t counters = 0;
+    size_t thread_names = 0;
+    size_t exited_thread_names = 0;
+
+protected:
+    void handle_thread_name(perfometer::utils::perf_thread_id thread_id, const std::string& name) override
+    {
+        if (name == "rotation test")
+        {
+            thread_names++;
+        }
+        else if (name == "exited thread")
+        {
+            exited_thread_names++;
+        }
+    }
+
+    void handle_work(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id,
+                     double time_start, double time_end) override
+    {
+        const std::string& name = string_by_id(string_id);
+
+        works++;
+
+        if (name == "work")
+        {
+            named_works++;
+        }
+        else if (name.compare(0, 8, "dynamic ") == 0)
+        {
+            dynamic_works++;
+        }
+        else
+        {
+            unnamed_works++;
+        }
+    }
+
+    void handle_counter(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id,
+                        double time, int64_t value) override
+    {
+        counters++;
+    }
+};
+
+bool file_exists(const std::string& file_name)
+{
+    return std::ifstream(file_name).good();
+}
+
+// segment file names after the first one get segment number suffix
+std::vector<std::string> segments(const char* file_name)
+{
+    std::vector<std::string> names;
+
+    if (file_exists(file_name))
+    {
+        names.push_back(file_name);
+    }
+
+    for (size_t i = 1; file_exists(std::string(file_name) + "." + std::to_string(i)); ++i)
+    {
+        names.push_back(std::string(file_name) + "." + std::to_string(i));
+    }
+
+    return names;
+}
+
+void log_records(size_t count, bool pause)
+{
+    perfometer::log_thread_name(perfometer::register_string("rotation test"));
+
+    const perfometer::string_id work_name = perfometer::register_string("work");
+    const perfometer::string_id counter_name = perfometer::register_string("counter");
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        perfometer::time t = perfometer::get_time();
+
+        perfometer::log_work(work_name, t, t + 10);
+
+        // same value repeats, written once per segment with skip_unchanged_counters
+        perfometer::log_counter(counter_name, t, 42);
+
+        if (i % 100 == 0)
+        {
+            const std::string dynamic = "dynamic " + std::to_string(i % 300);
+            perfometer::log_work(perfometer::write_string(dynamic.c_str(), dynamic.size()), t, t + 10);
+        }
+
+        if (pause && i % 100 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// every segment is a report of its own naming threads and records logged into it
+void check_rotation(perfometer::configuration config, size_t count, bool pause)
+{
+    const char* file_name = config.file_name;
+
+    CHECK(perfometer::initialize(config), perfometer::result::ok);
+
+    std::thread other([count, pause]() { log_records(count, pause); });
+    log_records(count, pause);
+    other.join();
+
+    CHECK(perfometer::shutdown(), perfometer::result::ok);
+
+    const std::vector<std::string> names = segments(file_name);
+    CHECK(names.size() >= 3, true);
+
+    size_t works = 0;
+    size_t unnamed_works = 0;
+
+    for (const std::string& name : names)
+    {
+        segment_reader reader;
+        CHECK(reader.process(name.c_str()), perfometer::result::ok);
+
+        works += reader.works;
+        unnamed_works += reader.unnamed_works;
+
+        if (reader.works)
+        {
+            CHECK(reader.named_works > 0, true);
+            CHECK(reader.thread_names > 0, true);
+            CHECK(reader.counters > 0, true);
+        }
+
+        std::remove(name.c_str());
+    }
+
+    CHECK(works, 2 * (count + count / 100));
+
+    // pages started before segment changed are written to previous one
+    CHECK(unnamed_works, 0);
+}
+
+// names of exited threads are not repeated in segments started after they exited
+void check_exited_thread_names(perfometer::configuration config)
+{
+    const char* file_name = config.file_name;
+
+    CHECK(perfometer::initialize(config), perfometer::result::ok);
+
+    std::thread exited([]()
+    {
+        perfometer::log_thread_name(perfometer::register_string("exited thread"));
+        perfometer::log_event(perfometer::register_string("work"), perfometer::get_time());
+    });
+    exited.join();
+
+    log_records(100000, false);
+
+    CHECK(perfometer::shutdown(), perfometer::result::ok);
+
+    const std::vector<std::string> names = segments(file_name);
+    CHECK(names.size() >= 3, true);
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        segment_reader reader;
+        CHECK(reader.process(names[i].c_str()), perfometer::result::ok);
+
+        if (i == 0)
+        {
+            CHECK(reader.exited_thread_names > 0, true);
+        }
+        else
+        {
+            CHECK(reader.exited_thread_names, 0);
+        }
+
+        std::remove(names[i].c_str());
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    // string record written by registering thread may follow records of the other thread
+    // using the id, registered before initialize they are in header of the first segment
+    perfometer::register_string("work");
+    perfometer::register_string("counter");
+
+    perfometer::configuration config;
+    config.file_name = "test_report_rotation.report";
+    config.skip_unchanged_counters = true;
+    config.rotate_size = 64 * 1024;
+    config.write_batch_size = 4096;
+
+    check_rotation(config, 100000, false);
+    check_exited_thread_names(config);
+
+    config.compression = true;
+    check_rotation(config, 100000, false);
+
+    config.rotate_size = 0;
+    config.rotate_interval_ms = 100;
+    config.logger_max_latency_ms = 10;
+    config.compression = false;
+    check_rotation(config, 40000, true);
+
+    return result;
+}
@@ -0,0 +1,264 @@
+/* Copyright 2023 Volodymyr Nikolaichuk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <utils/report_reader.h>
+#include <perfometer/sink.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#   include <sys/socket.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#endif
+
+template<typename T1, typename T2>
+void print_error(const T1& a, const T2& b, const char* desc_a, const char* desc_b)
+{
+    std::cout << "check failed " << desc_a << " != " << desc_b << std::endl;
+    std::cout << "Expected: " << b << ", actual: " << a << std::endl;
+}
+
+#define CHECK(a, b) if (a != b) { print_error(a, b, #a, #b); result = -1; }
+
+int result = 0;
+
+class counting_reader : public perfometer::utils::report_reader
+{
+public:
+    size_t works = 0;
+    size_t named_works = 0;
+    size_t unnamed_works = 0;
+    size_t events = 0;
+    size_t thread_names = 0;
+    std::string last_work_name;
+
+protected:
+    void handle_thread_name(perfometer::utils::perf_thread_id thread_id, const std::string& name) override
+    {
+        thread_names++;
+    }
+
+    void handle_work(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id,
+                     double time_start, double time_end) override
+    {
+        works++;
+        last_work_name = string_by_id(string_id);
+
+        if (last_work_name == "work")
+        {
+            named_works++;
+        }
+        else if (last_work_name.empty())
+        {
+            unnamed_works++;
+        }
+    }
+
+    void handle_event(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time) override
+    {
+        events++;
+    }
+};
+
+void log_records(perfometer::session& session, size_t count)
+{
+    perfometer::string_id work_name = perfometer::register_string("work");
+    perfometer::string_id event_name = perfometer::register_string("event");
+
+    session.log_thread_name(perfometer::register_string("stream test"));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        perfometer::time t = perfometer::get_time();
+
+        session.log_work(work_name, t, t + 10);
+        session.log_event(event_name, t);
+    }
+
+    const char dynamic[] = "dynamic work";
+    perfometer::string_id dynamic_name = session.write_string(dynamic, sizeof(dynamic) - 1);
+    perfometer::time t = perfometer::get_time();
+    session.log_work(dynamic_name, t, t + 10);
+}
+
+// report fed in chunks of any size gives the same records as report read from file
+void check_incremental_reading(bool compression)
+{
+    perfometer::memory_sink sink;
+
+    perfometer::configuration config;
+    config.report_sink = &sink;
+    config.compression = compression;
+    config.write_batch_size = 4096;
+
+    {
+        perfometer::session session;
+        CHECK(session.initialize(config), perfometer::result::ok);
+
+        log_records(session, 5000);
+
+        CHECK(session.shutdown(), perfometer::result::ok);
+    }
+
+    const std::vector<uint8_t> report = sink.data();
+
+    const char* file_name = "test_report_stream.report";
+    std::ofstream(file_name, std::ios::binary).write(reinterpret_cast<const char*>(report.data()), report.size());
+
+    counting_reader expected;
+    CHECK(expected.process(file_name), perfometer::result::ok);
+    CHECK(expected.works, 5001);
+    CHECK(expected.events, 5000);
+
+    for (size_t chunk : { size_t(1), size_t(7), size_t(1000), report.size() })
+    {
+        counting_reader reader;
+
+        for (size_t offset = 0; offset < report.size(); offset += chunk)
+        {
+            CHECK(reader.process_data(report.data() + offset, std::min(chunk, report.size() - offset)),
+                  perfometer::result::ok);
+        }
+
+        CHECK(reader.works, expected.works);
+        CHECK(reader.events, expected.events);
+        CHECK(reader.thread_names, expected.thread_names);
+        CHECK(reader.last_work_name, "dynamic work");
+        CHECK(reader.stats().duration, expected.stats().duration);
+    }
+
+    counting_reader wrong;
+    const char garbage[] = "NOT A PERFOMETER REPORT";
+    CHECK(wrong.process_data(garbage, sizeof(garbage)), perfometer::result::wrong_format);
+
+    std::remove(file_name);
+}
+
+#if !defined(_WIN32)
+int connect_to(const std::string& path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        close(client);
+        return -1;
+    }
+
+    return client;
+}
+
+// client connected from the start reads whole report, client connected later reads
+// strings and thread names written so far followed by pages written after it connected
+void check_socket_sink(bool compression)
+{
+    const std::string path = "/tmp/test_report_stream." + std::to_string(getpid()) + ".sock";
+
+    perfometer::socket_sink sink(path.c_str());
+    CHECK(sink.listening(), true);
+
+    perfometer::configuration config;
+    config.report_sink = &sink;
+    config.compression = compression;
+    config.write_batch_size = 4096;
+
+    int early_client = connect_to(path);
+    CHECK(early_client >= 0, true);
+
+    auto receive = [](int client, counting_reader& reader)
+    {
+        uint8_t buffer[1500];
+
+        ssize_t size;
+        while ((size = recv(client, buffer, sizeof(buffer), 0)) > 0)
+        {
+            if (reader.process_data(buffer, size) != perfometer::result::ok)
+            {
+                break;
+            }
+        }
+
+        close(client);
+    };
+
+    counting_reader early_reader;
+    std::thread early_thread(receive, early_client, std::ref(early_reader));
+
+    counting_reader late_reader;
+    std::thread late_thread;
+
+    {
+        perfometer::session session;
+        CHECK(session.initialize(config), perfometer::result::ok);
+
+        log_records(session, 5000);
+        CHECK(session.flush(), perfometer::result::ok);
+
+        int late_client = connect_to(path);
+        CHECK(late_client >= 0, true);
+
+        late_thread = std::thread(receive, late_client, std::ref(late_reader));
+
+        log_records(session, 1000);
+
+        CHECK(session.shutdown(), perfometer::result::ok);
+    }
+
+    CHECK(sink.close(), perfometer::result::ok);
+
+    early_thread.join();
+    late_thread.join();
+
+    CHECK(early_reader.works, 6002);
+    CHECK(early_reader.named_works, 6000);
+    CHECK(early_reader.events, 6000);
+
+    CHECK(late_reader.works > 0, true);
+    CHECK(late_reader.works < early_reader.works, true);
+    CHECK(late_reader.named_works > 0, true);
+    CHECK(late_reader.unnamed_works, 0);
+    CHECK(late_reader.thread_names > 0, true);
+    CHECK(late_reader.last_work_name, "dynamic work");
+
+    CHECK(connect_to(path), -1);
+}
+#endif
+
+int main(int argc, const char** argv)
+{
+    check_incremental_reading(false);
+    check_incremental_reading(true);
+
+#if !defined(_WIN32)
+    check_socket_sink(false);
+    check_socket_sink(true);
+#endif
+
+    return result;
+}
@@ -21,7 +21,10 @@ SOFTWARE. */
 #include "PerfometerReport.h"
 #include <perfometer/format.h>
 #include <perfometer/helpers.h>
+#include <algorithm>
 #include <cstring>
+#include <iterator>
+#include <unordered_set>
 #include <QDebug>
 
 namespace visualizer {
@@ -31,8 +34,9 @@ static const std::string UNKNOWN = "UNKNOWN";
 PerfometerReport::PerfometerReport()
     : m_startTime(std::numeric_limits<double>::max())
     , m_endTime(std::numeric_limits<double>::min())
+    , m_droppedUntil(0.0)
     , m_mainThreadID(0)
-    , m_dynamic_string_id(perfometer::format::invalid_string_id + 1)
+    , m_dynamic_string_id(uint64_t(perfometer::format::invalid_string_id) + 1)
 {
 }
 
@@ -57,6 +61,106 @@ bool PerfometerReport::loadFile(const std::string& fileName)
     return true;
 }
 
+bool PerfometerReport::processData(const char* data, size_t size)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    if (process_data(data, size) != perfometer::result::ok)
+    {
+        return false;
+    }
+
+    // dropping in steps of tenth of window, so kept records are not moved on every batch
+    const double windowStart = m_endTime - m_traits.LiveWindow;
+    if (windowStart > m_droppedUntil + m_traits.LiveWindow / 10)
+    {
+        dropRecordsBefore(windowStart);
+    }
+
+    return true;
+}
+
+void PerfometerReport::dropRecordsBefore(double time)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    // records and events are not move assignable, kept ones are moved into new vector
+    auto dropBefore = [](auto& items, auto kept)
+    {
+        if (kept == items.begin())
+        {
+            return;
+        }
+
+        std::remove_reference_t<decltype(items)> remaining;
+        remaining.reserve(items.end() - kept);
+
+        std::move(kept, items.end(), std::back_inserter(remaining));
+        items.swap(remaining);
+    };
+
+    for (auto& [id, thread] : m_threads)
+    {
+        // thread records are appended in order they end
+        dropBefore(thread->records, std::find_if(thread->records.begin(), thread->records.end(),
+                                                 [time](const Record& record) { return record.timeEnd >= time; }));
+
+        dropBefore(thread->events, std::find_if(thread->events.begin(), thread->events.end(),
+                                                [time](const Event& event) { return event.time >= time; }));
+    }
+
+    std::erase_if(m_flows, [time](const auto& it)
+    {
+        const Flow& flow = it.second;
+        return flow.points.empty() || flow.points.rbegin()->first < time;
+    });
+
+    // dynamic names only dropped records used go too, so per request labels do not pile up
+    // while window moves, names are referenced by kept records and found by address
+    std::unordered_set<const std::string*> used;
+
+    auto useNames = [&used](const auto& self, const std::vector<Record>& records) -> void
+    {
+        for (const Record& record : records)
+        {
+            used.insert(&record.name);
+            self(self, record.enclosed);
+        }
+    };
+
+    for (const auto& [id, thread] : m_threads)
+    {
+        useNames(useNames, thread->records);
+
+        for (const Event& event : thread->events)
+        {
+            used.insert(&event.name);
+        }
+    }
+
+    for (const auto& [id, flow] : m_flows)
+    {
+        for (const auto& [pointTime, point] : flow.points)
+        {
+            used.insert(&point.name);
+        }
+    }
+
+    std::erase_if(m_dynamic_strings, [this, &used](const auto& it)
+    {
+        if (used.count(&it.second))
+        {
+            return false;
+        }
+
+        m_dynamic_string_ids.erase(it.second);
+        return true;
+    });
+
+    m_startTime = std::max(m_startTime, time);
+    m_droppedUntil = time;
+}
+
 void PerfometerReport::log(const std::string& message)
 {
     qDebug() << message.c_str();
@@ -177,6 +281,53 @@ void PerfometerReport::handle_event(perfometer::string_id string_id, perfometer:
     m_endTime = std::max(m_endTime, event_time);
 }
 
+void PerfometerReport::handle_flow_begin(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id)
+{
+    if (Flow* flow = process_flow_point(string_id, thread_id, time, flow_id))
+    {
+        flow->begun = true;
+    }
+}
+
+void PerfometerReport::handle_flow_step(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id)
+{
+    process_flow_point(string_id, thread_id, time, flow_id);
+}
+
+void PerfometerReport::handle_flow_end(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id)
+{
+    if (Flow* flow = process_flow_point(string_id, thread_id, time, flow_id))
+    {
+        flow->ended = true;
+    }
+}
+
+Flow* PerfometerReport::process_flow_point(perfometer::string_id string_id,
+                                           perfometer::utils::perf_thread_id thread_id,
+                                           double time,
+                                           uint64_t flow_id)
+{
+    if (m_traits.SkipRecordsIncorrectTime)
+    {
+        if (time >= m_traits.RecordTimeMaxLimit)
+        {
+            return nullptr;
+        }
+    }
+
+    getThread(thread_id);
+
+    Flow& flow = m_flows.emplace(flow_id, Flow{flow_id}).first->second;
+
+    // pages of different threads are read in any order, points are kept sorted by time
+    flow.points.emplace(time, FlowPoint{thread_id, stringByID(check_for_dynamic_string(string_id))});
+
+    m_startTime = std::min(m_startTime, time);
+    m_endTime = std::max(m_endTime, time);
+
+    return &flow;
+}
+
 uint64_t PerfometerReport::check_for_dynamic_string(perfometer::string_id string_id)
 {
     if (string_id != perfometer::format::dynamic_string_id)
@@ -184,8 +335,13 @@ uint64_t PerfometerReport::check_for_dynamic_string(perfometer::string_id string
         return string_id;
     }
 
-    m_dynamic_strings[++m_dynamic_string_id] = string_by_id(string_id);
-    return m_dynamic_string_id;
+    auto inserted = m_dynamic_string_ids.emplace(string_by_id(string_id), m_dynamic_string_id + 1);
+    if (inserted.second)
+    {
+        m_dynamic_strings[++m_dynamic_string_id] = inserted.first->first;
+    }
+
+    return inserted.first->second;
 }
 
 const std::string& PerfometerReport::stringByID(uint64_t string_id)
@@ -200,6 +356,11 @@ const Threads& PerfometerReport::getThreads() const
     return m_threads;
 }
 
+const Flows& PerfometerReport::getFlows() const
+{
+    return m_flows;
+}
+
 ThreadPtr PerfometerReport::getThread(Thread::ID ID)
 {
     auto thread_pair = m_threads.emplace(ID, std::make_shared<Thread>(ID, thread_name_by_id(ID)));
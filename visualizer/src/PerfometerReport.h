@@ -65,6 +65,26 @@ namespace visualizer
         std::vector<Event> events;
     };
 
+    struct FlowPoint
+    {
+        Thread::ID threadID;
+        const std::string& name;
+    };
+
+    // records sharing flow id by time, begin or end is missing
+    // if report starts or ends while flow is in progress
+    struct Flow
+    {
+        uint64_t id;
+        std::multimap<double, FlowPoint> points;
+        bool begun = false;
+        bool ended = false;
+
+        double latency() const { return points.empty() ? 0.0 : points.rbegin()->first - points.begin()->first; }
+    };
+
+    using Flows = std::map<uint64_t, Flow>;
+
     using ThreadPtr = std::shared_ptr<Thread>;
     using ConstThreadPtr = std::shared_ptr<const Thread>;
 
@@ -80,6 +100,7 @@ namespace visualizer
             bool SkipRecordsIncorrectTime = true;
             double EmptyRecordLimit = 0.000000001;
             double RecordTimeMaxLimit = 24*60*60;
+            double LiveWindow = 60.0;   // seconds of attached live report kept in memory
         };
 
     public:
@@ -90,12 +111,17 @@ namespace visualizer
 
         bool loadFile(const std::string& fileName);
 
+        // feeds bytes of live report served by perfometer::socket_sink, records are appended
+        // to threads, records and events ended before last LiveWindow seconds are dropped
+        bool processData(const char* data, size_t size);
+
         double getStartTime() const { return m_startTime; }
         double getEndTime() const { return m_endTime; }
 
         Thread::ID mainThreadID() const { return m_mainThreadID; }
 
         const Threads& getThreads() const;
+        const Flows& getFlows() const;
         ThreadPtr getThread(Thread::ID id);
         ConstThreadPtr getThread(Thread::ID id) const;
 
@@ -111,22 +137,30 @@ namespace visualizer
         void handle_work(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time_start, double time_end) override;
         void handle_wait(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time_start, double time_end) override;
         void handle_event(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time) override;
+        void handle_flow_begin(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id) override;
+        void handle_flow_step(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id) override;
+        void handle_flow_end(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id) override;
 
         void process_record(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time_start, double time_end, bool wait);
+        void dropRecordsBefore(double time);
+        Flow* process_flow_point(perfometer::string_id string_id, perfometer::utils::perf_thread_id thread_id, double time, uint64_t flow_id);
         uint64_t check_for_dynamic_string(perfometer::string_id string_id);
         const std::string& stringByID(uint64_t string_id);
 
     private:
         double m_startTime;
         double m_endTime;
+        double m_droppedUntil;
 
         Traits  m_traits;
         Threads m_threads;
+        Flows   m_flows;
 
         Thread::ID m_mainThreadID;
 
         uint64_t m_dynamic_string_id;
         std::unordered_map<uint64_t, std::string> m_dynamic_strings;
+        std::unordered_map<std::string, uint64_t> m_dynamic_string_ids; // same text shares id
     };
 
 } // namespace visualizer
@@ -62,6 +62,7 @@ namespace visualizer {
     static QColor       ComponentHighlightColor         (48, 48, 48, 128);
     static QColor       RulerBackgroundColor            (228, 230, 241, 255);
     static QColor       SelectionColor                  (128, 230, 128, 32);
+    static QColor       FlowColor                       (230, 160, 64, 255);
 
     constexpr int NumColors = 8;
     static QColor Colors[NumColors] = { QColor(160, 96, 96, 255), // soft pink
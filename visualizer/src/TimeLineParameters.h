@@ -28,6 +28,7 @@ namespace visualizer {
     struct Parameters
     {
         bool showEvents = true;
+        bool showFlows = true;
     };
 
     struct RenderContext
@@ -113,6 +113,12 @@ TimeLineThread::TimeLineThread(TimeLineView& view, ConstThreadPtr thread)
     setHeight(thisHeight);
 }
 
+void TimeLineThread::updateHeight()
+{
+    auto thisHeight = calculateThreadHeight(&m_recordsHeight);
+    setHeight(thisHeight);
+}
+
 void TimeLineThread::mouseMove(QPointF pos)
 {
     PERFOMETER_LOG_WORK_FUNCTION();
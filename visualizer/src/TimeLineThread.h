@@ -40,6 +40,9 @@ namespace visualizer
     public:
         TimeLineThread(TimeLineView& view, ConstThreadPtr thread);
 
+        // thread of live report got new records, possibly nested deeper
+        void updateHeight();
+
         void mouseMove(QPointF pos) override;
         void mouseLeft() override;
         void mouseClick(QPointF pos) override;
@@ -48,6 +48,7 @@ TimeLineView::TimeLineView()
     , m_statusDisplayMode(StatusDisplayMode::None)
     , m_collapseAll(true)
     , m_offset(0.0f, 0.0f)
+    , m_reportEndTime(0.0)
 {
     setMouseTracking(true);
     setFocusPolicy(Qt::StrongFocus);
@@ -67,9 +68,12 @@ void TimeLineView::setReport(std::shared_ptr<PerfometerReport> report)
 {
     m_report = report;
 
-    m_components.emplace_back(std::make_shared<TimeLineThread>(
+    auto mainThread = std::make_shared<TimeLineThread>(
         *this, m_report->getThread(m_report->mainThreadID())
-    ));
+    );
+
+    m_components.emplace_back(mainThread);
+    m_threadComponents.emplace(m_report->mainThreadID(), mainThread);
 
     std::multimap<std::string, std::shared_ptr<TimeLineThread>> threads;
     for (const auto& it : m_report->getThreads())
@@ -77,8 +81,9 @@ void TimeLineView::setReport(std::shared_ptr<PerfometerReport> report)
         const Thread::ID tid = it.first;
         if (tid != m_report->mainThreadID())
         {
-            auto thread = it.second;
-            threads.emplace(thread->name, std::make_shared<TimeLineThread>(*this, thread));
+            auto thread = std::make_shared<TimeLineThread>(*this, it.second);
+            threads.emplace(it.second->name, thread);
+            m_threadComponents.emplace(tid, thread);
         }
     }
 
@@ -88,7 +93,59 @@ void TimeLineView::setReport(std::shared_ptr<PerfometerReport> report)
         m_components.emplace_back(thread);
     }
 
+    m_reportEndTime = m_report->getEndTime();
+
+    layout();
+}
+
+void TimeLineView::updateReport(std::shared_ptr<PerfometerReport> report)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    if (m_report != report)
+    {
+        // main thread is known once thread info and first records arrived
+        if (report->getThreads().empty())
+        {
+            return;
+        }
+
+        setReport(report);
+        update();
+        return;
+    }
+
+    const double pixpersec = pixelsPerSecond();
+    const bool followEnd = m_offset.x() + width() >= m_reportEndTime * pixpersec;
+
+    // threads started since previous update get lanes at the bottom
+    for (const auto& it : m_report->getThreads())
+    {
+        if (m_threadComponents.count(it.first) == 0)
+        {
+            auto thread = std::make_shared<TimeLineThread>(*this, it.second);
+
+            m_components.emplace_back(thread);
+            m_threadComponents.emplace(it.first, thread);
+        }
+    }
+
+    for (const auto& it : m_threadComponents)
+    {
+        it.second->updateHeight();
+    }
+
+    m_reportEndTime = m_report->getEndTime();
+
     layout();
+
+    const coord_t endOffset = m_reportEndTime * pixpersec - width();
+    if (followEnd && endOffset > m_offset.x())
+    {
+        scrollXTo(endOffset);
+    }
+
+    update();
 }
 
 void TimeLineView::onHorizontalScrollBarValueChanged(int value)
@@ -127,6 +184,7 @@ void TimeLineView::paintGL()
     painter.setFont(QFont(FontFace, FontSize));
 
     QPointF pos(-m_offset.x(), RulerHeight + RulerDistReport - m_offset.y());
+    const QPointF reportPos(pos);
 
     m_statistics = Statistics();
 
@@ -154,6 +212,11 @@ void TimeLineView::paintGL()
         }
     }
 
+    if (m_report && m_parameters.showFlows)
+    {
+        drawFlows(painter, viewport, reportPos);
+    }
+
     for (auto& component : m_components)
     {
         component->renderOverlay(painter, RenderContext{viewport, pos}, m_parameters);
@@ -327,6 +390,11 @@ void TimeLineView::keyPressEvent(QKeyEvent* event)
             m_parameters.showEvents = !m_parameters.showEvents;
             break;
         }
+        case Qt::Key_F:
+        {
+            m_parameters.showFlows = !m_parameters.showFlows;
+            break;
+        }
         case Qt::Key_V:
         {
             if (ctrl)
@@ -687,6 +755,85 @@ void TimeLineView::drawStatusMessage(QPainter& painter)
                      stream.str().c_str());
 }
 
+// points of flow are connected in time order at titles of their thread lanes,
+// flow latency is written next to its last point
+void TimeLineView::drawFlows(QPainter& painter, QRectF viewport, QPointF pos)
+{
+    PERFOMETER_LOG_WORK_FUNCTION();
+
+    const auto pixpersec = pixelsPerSecond();
+
+    std::map<const TimeLineComponent*, coord_t> componentY;
+
+    coord_t y = viewport.top() + pos.y();
+    for (const auto& component : m_components)
+    {
+        componentY[component.get()] = y;
+        y += component->height();
+    }
+
+    std::map<Thread::ID, coord_t> laneY;
+    for (const auto& it : m_threadComponents)
+    {
+        laneY[it.first] = componentY[it.second.get()] + ThreadTitleHeight / 2;
+    }
+
+    const coord_t left = viewport.left() + pos.x();
+
+    painter.setPen(QPen(QBrush(FlowColor), 1));
+    painter.setBrush(FlowColor);
+
+    QString text;
+
+    for (const auto& it : m_report->getFlows())
+    {
+        const Flow& flow = it.second;
+        if (flow.points.empty())
+        {
+            continue;
+        }
+
+        const coord_t xBegin = left + flow.points.begin()->first * pixpersec;
+        const coord_t xEnd = left + flow.points.rbegin()->first * pixpersec;
+        if (xEnd < viewport.left() || xBegin > viewport.right())
+        {
+            continue;
+        }
+
+        QPointF previous;
+        bool hasPrevious = false;
+
+        for (const auto& point : flow.points)
+        {
+            auto lane = laneY.find(point.second.threadID);
+            if (lane == laneY.end())
+            {
+                continue;
+            }
+
+            const QPointF current(left + point.first * pixpersec, lane->second);
+
+            if (hasPrevious)
+            {
+                painter.drawLine(previous, current);
+            }
+
+            painter.drawEllipse(current, 2, 2);
+
+            previous = current;
+            hasPrevious = true;
+        }
+
+        if (hasPrevious && flow.points.size() > 1)
+        {
+            text = text.fromStdString(flow.points.begin()->second.name + " " +
+                                      perfometer::utils::time_to_string(flow.latency()));
+            painter.drawText(QRectF(previous.x() + TitleOffsetSmall, previous.y(), StatusMessageWidth, RecordHeight),
+                             Qt::AlignVCenter | Qt::AlignLeft, text);
+        }
+    }
+}
+
 void TimeLineView::layout()
 {
     PERFOMETER_LOG_WORK_FUNCTION();
@@ -27,10 +27,13 @@ SOFTWARE. */
 #include "TimeLineConfig.h"
 #include "PerfometerReport.h"
 #include "TimeLineComponent.h"
+#include <map>
 #include <memory>
 
 namespace visualizer
 {
+    class TimeLineThread;
+
     class TimeLineView : public QOpenGLWidget,
                                 QOpenGLFunctions
     {
@@ -42,6 +45,10 @@ namespace visualizer
 
         void setReport(std::shared_ptr<PerfometerReport> report);
 
+        // live report got new data, sets report on first call, adds lanes of new threads,
+        // view showing end of report keeps following it
+        void updateReport(std::shared_ptr<PerfometerReport> report);
+
         double pixelsPerSecond() const;
         double secondsPerPixel() const;
 
@@ -82,6 +89,7 @@ namespace visualizer
         void drawRuler(QPainter& painter, QPointF& pos);
 
         void drawStatusMessage(QPainter& painter);
+        void drawFlows(QPainter& painter, QRectF viewport, QPointF pos);
 
         void layout();
 
@@ -121,6 +129,8 @@ namespace visualizer
         std::shared_ptr<PerfometerReport>   m_report;
 
         std::vector<ComponentPtr>           m_components;
+        std::map<Thread::ID, std::shared_ptr<TimeLineThread>> m_threadComponents;
+        double                              m_reportEndTime;
 
         ComponentPtr                        m_componentUnderMouse;
         ComponentPtr                        m_componentWithFocus;
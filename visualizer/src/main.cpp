@@ -19,10 +19,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE. */
 
 #include <QApplication>
+#include <QDebug>
+#include <QLocalSocket>
 #include <QMainWindow>
 #include <QMessageBox>
 #include "TimeLineView.h"
 #include "PerfometerReport.h"
+#include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <fstream>
@@ -32,6 +35,8 @@ SOFTWARE. */
 struct options
 {
     std::string reportFileName;
+    std::string attachSocketPath;   // --attach, socket of perfometer::socket_sink
+    double      liveWindow = 60.0;  // --window, seconds of live report kept
     bool        profile = false;
 };
 
@@ -58,19 +63,23 @@ void MessageHandler(QtMsgType type, const QMessageLogContext& context, const QSt
 
 void parseCommandline(options& opts, int argc, char* argv[])
 {
-    if (argc > 1)
+    for (int i = 1; i < argc; ++i)
     {
-        opts.reportFileName = argv[1];
-
-        if (argc > 2)
+        if (strcmp(argv[i], "--profile") == 0)
         {
-            for (int i = 2; i < argc; ++i)
-            {
-                if (strcmp(argv[i], "--profile") == 0)
-                {
-                    opts.profile = true;
-                }
-            }
+            opts.profile = true;
+        }
+        else if (strcmp(argv[i], "--attach") == 0 && i + 1 < argc)
+        {
+            opts.attachSocketPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc)
+        {
+            opts.liveWindow = std::atof(argv[++i]);
+        }
+        else if (i == 1)
+        {
+            opts.reportFileName = argv[i];
         }
     }
 }
@@ -130,6 +139,54 @@ int main(int argc, char** argv)
         }
     }
 
+    QLocalSocket liveSocket;
+
+    if (opts.attachSocketPath.length())
+    {
+        visualizer::PerfometerReport::Traits traits;
+        traits.LiveWindow = opts.liveWindow;
+
+        auto report = std::make_shared<visualizer::PerfometerReport>(traits);
+
+        QObject::connect(&liveSocket, &QLocalSocket::readyRead, [&liveSocket, report, timeLineView]()
+        {
+            QByteArray data = liveSocket.readAll();
+
+            if (!report->processData(data.constData(), data.size()))
+            {
+                qCritical() << "Wrong live report data, detaching";
+                liveSocket.abort();
+                return;
+            }
+
+            timeLineView->updateReport(report);
+        });
+
+        const QString titleWithSocket = QString(title) + " - " + QString::fromStdString(opts.attachSocketPath);
+
+        QObject::connect(&liveSocket, &QLocalSocket::disconnected, [&window, titleWithSocket]()
+        {
+            window.setWindowTitle(titleWithSocket + " (detached)");
+        });
+
+        liveSocket.connectToServer(QString::fromStdString(opts.attachSocketPath));
+
+        if (liveSocket.waitForConnected(1000))
+        {
+            window.setWindowTitle(titleWithSocket + " (live)");
+        }
+        else
+        {
+            QString text;
+            text = text.fromStdString(opts.attachSocketPath);
+            text.prepend("Cannot attach to ");
+
+            QMessageBox messageBox;
+            messageBox.setText(text);
+            messageBox.exec();
+        }
+    }
+
     int retval = app.exec();
 
     if (opts.profile)